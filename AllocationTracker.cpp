@@ -0,0 +1,174 @@
+#include "AllocationTracker.h"
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define CALLER_ADDRESS() _ReturnAddress()
+#else
+#define CALLER_ADDRESS() __builtin_return_address(0)
+#endif
+
+using namespace std;
+
+// Everything here is constant-initialised, so it is usable even by
+// allocations made before main; nothing in the hooks may allocate.
+static atomic<bool> tracking(false);
+static atomic<unsigned long long> epoch(0);
+static atomic<unsigned long long> allocCount(0);
+static atomic<unsigned long long> freeCount(0);
+static atomic<unsigned long long> bytesAllocated(0);
+static atomic<long long> liveBytes(0);
+static atomic<long long> peakBytes(0);
+static atomic<int> sampleEvery(0);
+
+static const size_t SITE_SLOTS = 1024;
+
+struct SiteSlot {
+    atomic<const void*> address;
+    atomic<unsigned long long> samples;
+    atomic<unsigned long long> bytes;
+};
+static SiteSlot sites[SITE_SLOTS];
+
+#ifdef BENCHMARK_TRACK_ALLOCATIONS
+
+static void recordSite(const void* site, size_t size) {
+    size_t h = ((size_t)site >> 4) % SITE_SLOTS;
+    for (size_t probe = 0; probe < SITE_SLOTS; probe++) {
+        SiteSlot& slot = sites[(h + probe) % SITE_SLOTS];
+        const void* current = slot.address.load(memory_order_relaxed);
+        if (current == nullptr) {
+            const void* empty = nullptr;
+            if (slot.address.compare_exchange_strong(empty, site)) current = site;
+            else current = empty;
+        }
+        if (current == site) {
+            slot.samples.fetch_add(1, memory_order_relaxed);
+            slot.bytes.fetch_add(size, memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+// Size and tracking epoch live in front of every block, so a free can tell
+// whether the block was counted by the current start()
+struct alignas(max_align_t) BlockHeader {
+    size_t size;
+    unsigned long long epoch;
+};
+
+static void* trackedAlloc(size_t size, const void* site) {
+    BlockHeader* header = (BlockHeader*)malloc(sizeof(BlockHeader) + size);
+    if (!header) return nullptr;
+    header->size = size;
+    header->epoch = 0;
+
+    if (tracking.load(memory_order_relaxed)) {
+        header->epoch = epoch.load(memory_order_relaxed);
+        unsigned long long n = allocCount.fetch_add(1, memory_order_relaxed) + 1;
+        bytesAllocated.fetch_add(size, memory_order_relaxed);
+
+        long long live = liveBytes.fetch_add((long long)size, memory_order_relaxed) + (long long)size;
+        long long peak = peakBytes.load(memory_order_relaxed);
+        while (live > peak && !peakBytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {}
+
+        int every = sampleEvery.load(memory_order_relaxed);
+        if (every > 0 && n % (unsigned long long)every == 0) recordSite(site, size);
+    }
+    return header + 1;
+}
+
+static void trackedFree(void* p) {
+    if (!p) return;
+    BlockHeader* header = (BlockHeader*)p - 1;
+    if (header->epoch != 0 && tracking.load(memory_order_relaxed) &&
+        header->epoch == epoch.load(memory_order_relaxed)) {
+        freeCount.fetch_add(1, memory_order_relaxed);
+        liveBytes.fetch_sub((long long)header->size, memory_order_relaxed);
+    }
+    free(header);
+}
+
+void* operator new(size_t size) {
+    void* p = trackedAlloc(size, CALLER_ADDRESS());
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    void* p = trackedAlloc(size, CALLER_ADDRESS());
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    return trackedAlloc(size, CALLER_ADDRESS());
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+    return trackedAlloc(size, CALLER_ADDRESS());
+}
+
+void operator delete(void* p) noexcept { trackedFree(p); }
+void operator delete[](void* p) noexcept { trackedFree(p); }
+void operator delete(void* p, size_t) noexcept { trackedFree(p); }
+void operator delete[](void* p, size_t) noexcept { trackedFree(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { trackedFree(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { trackedFree(p); }
+
+bool AllocationTracker::isInstalled() {
+    return true;
+}
+
+#else
+
+bool AllocationTracker::isInstalled() {
+    return false;
+}
+
+#endif
+
+void AllocationTracker::start(int every) {
+    tracking = false;
+    epoch++;
+    allocCount = 0;
+    freeCount = 0;
+    bytesAllocated = 0;
+    liveBytes = 0;
+    peakBytes = 0;
+    for (SiteSlot& slot : sites) {
+        slot.address = nullptr;
+        slot.samples = 0;
+        slot.bytes = 0;
+    }
+    sampleEvery = every;
+    tracking = true;
+}
+
+AllocationStats AllocationTracker::stop() {
+    tracking = false;
+
+    AllocationStats stats;
+    stats.allocations = allocCount;
+    stats.deallocations = freeCount;
+    stats.bytesAllocated = bytesAllocated;
+    stats.peakLiveBytes = (unsigned long long)max(0LL, peakBytes.load());
+    return stats;
+}
+
+vector<AllocationSite> AllocationTracker::topSites(size_t count) {
+    vector<AllocationSite> out;
+    for (SiteSlot& slot : sites) {
+        const void* address = slot.address.load();
+        if (address) out.push_back({ address, slot.samples.load(), slot.bytes.load() });
+    }
+
+    sort(out.begin(), out.end(), [](const AllocationSite& a, const AllocationSite& b) {
+        return a.bytes > b.bytes;
+    });
+    if (out.size() > count) out.resize(count);
+    return out;
+}
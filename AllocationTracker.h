@@ -0,0 +1,35 @@
+#ifndef ALLOCATIONTRACKER_H
+#define ALLOCATIONTRACKER_H
+
+#include <vector>
+#include <cstddef>
+
+struct AllocationStats {
+    unsigned long long allocations = 0;
+    unsigned long long deallocations = 0;
+    unsigned long long bytesAllocated = 0;
+    unsigned long long peakLiveBytes = 0;  // counts only blocks allocated since start()
+};
+
+struct AllocationSite {
+    const void* address;  // return address of the operator new call
+    unsigned long long samples;
+    unsigned long long bytes;
+};
+
+// Counts heap traffic through replaced global operator new/delete. The
+// replacement is only compiled in when BENCHMARK_TRACK_ALLOCATIONS is defined,
+// since it adds a small header to every allocation in the program; without it
+// isInstalled() is false and start()/stop() report nothing.
+class AllocationTracker {
+public:
+    static bool isInstalled();
+
+    // Resets the counters and starts counting. With sampleEvery > 0, every
+    // Nth allocation also records its call site.
+    static void start(int sampleEvery = 0);
+    static AllocationStats stop();
+    static std::vector<AllocationSite> topSites(size_t count);
+};
+
+#endif
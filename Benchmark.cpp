@@ -1,40 +1,292 @@
 #include "Benchmark.h"
+#include "ConsistencyChecker.h"
+#include "CourseGraph.h"
+#include "WorkloadGenerator.h"
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cmath>
 #include <iomanip>
+#include <algorithm>
 #include <map>
+#include <memory>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
 
 using namespace std;
 
-Benchmark::Benchmark() {}
+// CPU time consumed by the calling thread, next to wall time it separates
+// compute from waiting (I/O, fsync, scheduling)
+static double cpuTimeMs() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime; u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) / 10000.0;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+static double median(vector<double> v) {
+    sort(v.begin(), v.end());
+    size_t n = v.size();
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2.0;
+}
+
+Benchmark::Benchmark() : trackAllocations(false), allocationSampleEvery(0) {}
+
+Benchmark::Benchmark(const BenchmarkOptions& opts)
+    : options(opts), trackAllocations(false), allocationSampleEvery(0) {}
+
+void Benchmark::enableAllocationTracking(bool enable, int sampleEvery) {
+    if (enable && !AllocationTracker::isInstalled()) {
+        cout << "[WARN] Allocation tracking needs a build with BENCHMARK_TRACK_ALLOCATIONS defined\n";
+        enable = false;
+    }
+    trackAllocations = enable;
+    allocationSampleEvery = sampleEvery;
+}
+
+void Benchmark::enablePerfCounters(bool enable) {
+    if (!enable) {
+        perf.reset();
+        return;
+    }
+    if (perf) return;
+
+    perf.reset(new PerfCounters());
+    if (!perf->open()) {
+        cout << "[WARN] Hardware counters unavailable (perf_event_open not permitted or unsupported); "
+            << "reporting timings only\n";
+    }
+}
 
+// Warms up, then repeats until both minRepetitions and minTotalMs are reached
+// (capped at maxRepetitions). Any false return or exception fails the test.
 void Benchmark::runTest(const string& name, function<bool()> testFunc) {
     cout << "Running: " << name << "... ";
 
-    double time = measureTime([&]() {
-        testFunc();
+    bool passed = true;
+    auto runOnce = [&]() {
+        try {
+            if (!testFunc()) passed = false;
+        }
+        catch (...) {
+            passed = false;
+        }
+    };
+
+    for (int i = 0; i < options.warmupIterations; i++) runOnce();
+
+    // Sized up front so the harness itself does not allocate while measuring
+    vector<double> wall, cpu;
+    wall.reserve(options.maxRepetitions);
+    cpu.reserve(options.maxRepetitions);
+    double total = 0;
+    if (trackAllocations) AllocationTracker::start(allocationSampleEvery);
+    if (perf) perf->start();
+    while ((int)wall.size() < options.maxRepetitions &&
+        ((int)wall.size() < options.minRepetitions || total < options.minTotalMs)) {
+        double cpuStart = cpuTimeMs();
+        double time = measureTime(runOnce);
+        cpu.push_back(cpuTimeMs() - cpuStart);
+        wall.push_back(time);
+        total += time;
+    }
+    if (perf) perf->stop();
+    AllocationStats allocations;
+    if (trackAllocations) allocations = AllocationTracker::stop();
+
+    TestResult r;
+    r.testName = name;
+    r.passed = passed;
+    r.repetitions = (int)wall.size();
+    r.timeMs = median(wall);
+    r.cpuMs = median(cpu);
+
+    vector<double> sorted = wall;
+    sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    r.minMs = sorted.front();
+    r.meanMs = total / n;
+    double sq = 0;
+    for (double t : sorted) sq += (t - r.meanMs) * (t - r.meanMs);
+    r.stddevMs = n > 1 ? sqrt(sq / (n - 1)) : 0.0;
+    r.p99Ms = sorted[(size_t)ceil(0.99 * n) - 1];
+
+    r.hasCounters = perf != nullptr;
+    for (int e = 0; e < PerfCounters::EventCount; e++) {
+        PerfCounters::Event event = PerfCounters::Event(e);
+        r.counters[e] = perf && perf->isAvailable(event) ? perf->value(event) / (double)n : -1;
+    }
+
+    r.hasAllocations = trackAllocations;
+    r.allocationsPerRun = allocations.allocations / (double)n;
+    r.bytesPerRun = allocations.bytesAllocated / (double)n;
+    r.peakLiveBytes = allocations.peakLiveBytes;
+    if (trackAllocations && allocationSampleEvery > 0) r.topSites = AllocationTracker::topSites(5);
+    results.push_back(r);
+
+    cout << "Done (median " << fixed << setprecision(3) << r.timeMs << " ms over "
+        << r.repetitions << " runs)\n";
+}
+
+// Least squares fit of y = a + b*x; returns b and the coefficient of determination
+static void fitLine(const vector<double>& x, const vector<double>& y, double& slope, double& r2) {
+    size_t n = x.size();
+    double mx = 0, my = 0;
+    for (size_t i = 0; i < n; i++) { mx += x[i]; my += y[i]; }
+    mx /= n;
+    my /= n;
+
+    double sxy = 0, sxx = 0, syy = 0;
+    for (size_t i = 0; i < n; i++) {
+        sxy += (x[i] - mx) * (y[i] - my);
+        sxx += (x[i] - mx) * (x[i] - mx);
+        syy += (y[i] - my) * (y[i] - my);
+    }
+    slope = sxx > 0 ? sxy / sxx : 0;
+    r2 = sxx > 0 && syy > 0 ? (sxy * sxy) / (sxx * syy) : 1.0;
+}
+
+double Benchmark::runScaling(const string& name, const vector<int>& sizes,
+    function<function<bool()>(int)> makeTest) {
+    vector<double> logN, n, logT;
+    for (int size : sizes) {
+        runTest(name + " n=" + to_string(size), makeTest(size));
+        double t = results.back().timeMs;
+        if (t <= 0) continue;
+        n.push_back(size);
+        logN.push_back(log((double)size));
+        logT.push_back(log(t));
+    }
+
+    if (n.size() < 2) {
+        cout << "  " << name << ": not enough timed sizes to fit\n";
+        return 0;
+    }
+
+    double k, r2Poly, rate, r2Exp;
+    fitLine(logN, logT, k, r2Poly);
+    fitLine(n, logT, rate, r2Exp);
+
+    cout << "  " << name << ": empirical complexity ";
+    if (r2Exp > r2Poly && k > 3) {
+        cout << "~O(" << fixed << setprecision(3) << exp(rate) << "^n)  (R^2 " << r2Exp << ")\n";
+    }
+    else {
+        cout << "~O(n^" << fixed << setprecision(2) << k << ")  (R^2 " << setprecision(3) << r2Poly << ")\n";
+    }
+    cout << setprecision(3);
+    return k;
+}
+
+// Silences cout for its lifetime; the checker reports every step to stdout,
+// which would otherwise dominate (and flood) the measurement
+struct QuietOutput {
+    QuietOutput() { cout.setstate(ios::failbit); }
+    ~QuietOutput() { cout.clear(); }
+};
+
+void Benchmark::testScalingSuite(unsigned long long seed) {
+    cout << "\n>> Scaling Suite (seed " << seed << ")\n";
+
+    // Narrow layers keep the antichain state space, and so the count, tractable
+    runScaling("countSequences", { 12, 16, 20, 24, 28 }, [seed](int n) -> function<bool()> {
+        auto graph = make_shared<CourseGraph>();
+        WorkloadGenerator(seed).generateCatalog(*graph, n, 3, 0.5);
+        return [graph]() {
+            unsigned long long count = graph->countSequences();
+            doNotOptimize(count);
+            return count > 0;
+        };
+        });
+
+    runScaling("enumerateSequences(cap 1000)", { 50, 100, 200, 400 }, [seed](int n) -> function<bool()> {
+        auto graph = make_shared<CourseGraph>();
+        WorkloadGenerator(seed).generateCatalog(*graph, n, 4, 0.5);
+        return [graph]() {
+            vector<vector<int>> sequences;
+            graph->enumerateSequences(sequences, 1000);
+            doNotOptimize(sequences);
+            return !sequences.empty();
+        };
         });
 
-    bool passed = true; // Assume passed if no exception
-    results.push_back({ name, time, passed });
+    runScaling("hasCycle", { 10000, 40000, 160000, 640000 }, [seed](int n) -> function<bool()> {
+        auto graph = make_shared<CourseGraph>();
+        WorkloadGenerator(seed).generateCatalog(*graph, n, 100, 0.02);
+        return [graph]() {
+            bool cyclic = graph->hasCycle();
+            doNotOptimize(cyclic);
+            return !cyclic;
+        };
+        });
+
+    runScaling("checkAll", { 25, 50, 100, 200 }, [seed](int n) -> function<bool()> {
+        auto checker = make_shared<ConsistencyChecker>();
+        WorkloadGenerator gen(seed);
+        vector<string> courses = gen.generateCatalog(*checker, n, 10, 0.1);
+        gen.generatePopulation(*checker, courses, n * 2, 4, n / 4 + 1, n / 2 + 1, 20);
+        return [checker]() {
+            QuietOutput quiet;
+            bool consistent = checker->checkAll();
+            doNotOptimize(consistent);
+            return true;
+        };
+        });
 
-    cout << "Done (" << fixed << setprecision(3) << time << " ms)\n";
+    // Each run enrolls a fresh batch of 100 students, so the checker grows
+    // slowly across repetitions
+    runScaling("enrollStudentInCourse x100", { 1000, 4000, 16000, 64000 }, [seed](int n) -> function<bool()> {
+        auto checker = make_shared<ConsistencyChecker>();
+        WorkloadGenerator gen(seed);
+        // One layer, no prerequisites: every course is open to new students
+        vector<string> courses = gen.generateCatalog(*checker, 200, 200, 0.0);
+        gen.generatePopulation(*checker, courses, n / 4, 4, 50, 80, 20);
+        auto next = make_shared<int>(0);
+        return [checker, courses, next]() {
+            QuietOutput quiet;
+            for (int i = 0; i < 100; i++, (*next)++) {
+                checker->enrollStudentInCourse("NEW" + to_string(*next),
+                    courses[*next % courses.size()], "T" + to_string(*next % 20));
+            }
+            return true;
+        };
+        });
 }
 
 void Benchmark::displayResults() const {
-    cout << "\n========================================================================\n";
-    cout << "||              PERFORMANCE ANALYSIS SUMMARY                         ||\n";
-    cout << "========================================================================\n\n";
+    cout << "\n==================================================================================================\n";
+    cout << "||                          PERFORMANCE ANALYSIS SUMMARY                                       ||\n";
+    cout << "==================================================================================================\n\n";
 
-    cout << left << setw(40) << "Test Description" << setw(15) << "Duration (ms)" << "Status\n";
-    cout << string(70, '-') << "\n";
+    cout << left << setw(34) << "Test Description" << right
+        << setw(10) << "Median" << setw(10) << "Min" << setw(10) << "Mean" << setw(10) << "StdDev"
+        << setw(10) << "P99" << setw(10) << "CPU" << setw(7) << "Runs" << "  Status\n";
+    cout << left << setw(34) << "" << right << setw(60) << "(all times in ms)" << "\n";
+    cout << string(98, '-') << "\n";
 
     for (const TestResult& r : results) {
-        cout << left << setw(40) << r.testName
-            << setw(15) << fixed << setprecision(3) << r.timeMs
-            << (r.passed ? "[PASS]" : "[FAIL]") << "\n";
+        cout << left << setw(34) << r.testName << right << fixed << setprecision(3)
+            << setw(10) << r.timeMs << setw(10) << r.minMs << setw(10) << r.meanMs
+            << setw(10) << r.stddevMs << setw(10) << r.p99Ms << setw(10) << r.cpuMs
+            << setw(7) << r.repetitions
+            << (r.passed ? "  [PASS]" : "  [FAIL]") << "\n";
     }
 
-    cout << string(70, '-') << "\n";
+    cout << string(98, '-') << "\n";
 
     double totalTime = 0;
     int passCount = 0;
@@ -43,9 +295,189 @@ void Benchmark::displayResults() const {
         if (r.passed) passCount++;
     }
 
-    cout << "Cumulative Duration: " << totalTime << " ms\n";
+    cout << left << "Cumulative Median Duration: " << totalTime << " ms\n";
     cout << "Tests Passed: " << passCount << "/" << results.size() << "\n";
-    cout << "========================================================================\n";
+
+    bool anyCounters = false;
+    for (const TestResult& r : results) anyCounters = anyCounters || r.hasCounters;
+    if (anyCounters) {
+        auto cell = [](double v) {
+            ostringstream s;
+            if (v < 0) s << "n/a";
+            else s << fixed << setprecision(0) << v;
+            return s.str();
+        };
+
+        cout << "\nHardware counters (average per run):\n";
+        cout << left << setw(34) << "Test Description" << right
+            << setw(12) << "Cycles" << setw(12) << "Instr" << setw(6) << "IPC"
+            << setw(10) << "L1D miss" << setw(10) << "LLC miss" << setw(10) << "Br miss"
+            << setw(8) << "PgFlt" << "\n";
+        cout << string(98, '-') << "\n";
+
+        for (const TestResult& r : results) {
+            if (!r.hasCounters) continue;
+            const double* c = r.counters;
+            string ipc = c[PerfCounters::Cycles] > 0 && c[PerfCounters::Instructions] >= 0
+                ? to_string(c[PerfCounters::Instructions] / c[PerfCounters::Cycles]).substr(0, 4) : "n/a";
+            cout << left << setw(34) << r.testName << right
+                << setw(12) << cell(c[PerfCounters::Cycles]) << setw(12) << cell(c[PerfCounters::Instructions])
+                << setw(6) << ipc << setw(10) << cell(c[PerfCounters::L1DMisses])
+                << setw(10) << cell(c[PerfCounters::LLCMisses]) << setw(10) << cell(c[PerfCounters::BranchMisses])
+                << setw(8) << cell(c[PerfCounters::PageFaults]) << "\n";
+        }
+    }
+
+    bool anyAllocations = false;
+    for (const TestResult& r : results) anyAllocations = anyAllocations || r.hasAllocations;
+    if (anyAllocations) {
+        cout << "\nHeap allocations:\n";
+        cout << left << setw(34) << "Test Description" << right
+            << setw(16) << "Allocs/run" << setw(16) << "Bytes/run" << setw(16) << "Peak live" << "\n";
+        cout << string(98, '-') << "\n";
+
+        for (const TestResult& r : results) {
+            if (!r.hasAllocations) continue;
+            cout << left << setw(34) << r.testName << right << fixed << setprecision(1)
+                << setw(16) << r.allocationsPerRun << setw(16) << r.bytesPerRun
+                << setw(16) << r.peakLiveBytes << "\n";
+            for (const AllocationSite& site : r.topSites) {
+                cout << "    site " << site.address << ": " << site.samples << " sampled, "
+                    << site.bytes << " bytes\n";
+            }
+        }
+        cout << setprecision(3);
+    }
+    cout << "==================================================================================================\n";
+}
+
+static string jsonEscape(const string& s) {
+    string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static string csvQuote(const string& s) {
+    string out = "\"";
+    for (char c : s) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+bool Benchmark::exportJSON(const string& path) const {
+    ofstream out(path);
+    if (!out) return false;
+
+    out << fixed << setprecision(6) << "{\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const TestResult& r = results[i];
+        out << "    { \"name\": \"" << jsonEscape(r.testName) << "\""
+            << ", \"passed\": " << (r.passed ? "true" : "false")
+            << ", \"repetitions\": " << r.repetitions
+            << ", \"median_ms\": " << r.timeMs
+            << ", \"min_ms\": " << r.minMs
+            << ", \"mean_ms\": " << r.meanMs
+            << ", \"stddev_ms\": " << r.stddevMs
+            << ", \"p99_ms\": " << r.p99Ms
+            << ", \"cpu_ms\": " << r.cpuMs;
+        for (int e = 0; r.hasCounters && e < PerfCounters::EventCount; e++) {
+            if (r.counters[e] >= 0) {
+                out << ", \"" << PerfCounters::eventName(PerfCounters::Event(e)) << "\": " << r.counters[e];
+            }
+        }
+        if (r.hasAllocations) {
+            out << ", \"allocations_per_run\": " << r.allocationsPerRun
+                << ", \"bytes_per_run\": " << r.bytesPerRun
+                << ", \"peak_live_bytes\": " << r.peakLiveBytes;
+        }
+        out << " }"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return (bool)out;
+}
+
+bool Benchmark::exportCSV(const string& path) const {
+    ofstream out(path);
+    if (!out) return false;
+
+    out << "name,passed,repetitions,median_ms,min_ms,mean_ms,stddev_ms,p99_ms,cpu_ms";
+    for (int e = 0; e < PerfCounters::EventCount; e++) out << "," << PerfCounters::eventName(PerfCounters::Event(e));
+    out << ",allocations_per_run,bytes_per_run,peak_live_bytes\n" << fixed << setprecision(6);
+    for (const TestResult& r : results) {
+        out << csvQuote(r.testName) << "," << (r.passed ? 1 : 0) << "," << r.repetitions << ","
+            << r.timeMs << "," << r.minMs << "," << r.meanMs << "," << r.stddevMs << ","
+            << r.p99Ms << "," << r.cpuMs;
+        for (int e = 0; e < PerfCounters::EventCount; e++) {
+            out << ",";
+            if (r.hasCounters && r.counters[e] >= 0) out << r.counters[e];
+        }
+        if (r.hasAllocations) out << "," << r.allocationsPerRun << "," << r.bytesPerRun << "," << r.peakLiveBytes;
+        else out << ",,,";
+        out << "\n";
+    }
+    return (bool)out;
+}
+
+// Reads the name and median columns of a file written by exportCSV
+bool Benchmark::loadBaseline(const string& csvPath) {
+    ifstream in(csvPath);
+    if (!in) return false;
+
+    baseline.clear();
+    string line;
+    getline(in, line);  // header
+    while (getline(in, line)) {
+        if (line.empty() || line[0] != '"') continue;
+
+        string name;
+        size_t i = 1;
+        for (; i < line.size(); i++) {
+            if (line[i] == '"') {
+                if (i + 1 < line.size() && line[i + 1] == '"') { name += '"'; i++; }
+                else break;
+            }
+            else name += line[i];
+        }
+
+        // Skip ",passed,repetitions," to reach median_ms
+        stringstream rest(line.substr(i + 2));
+        string field;
+        getline(rest, field, ',');
+        getline(rest, field, ',');
+        if (getline(rest, field, ',')) baseline[name] = atof(field.c_str());
+    }
+    return true;
+}
+
+// Returns false if any test's median got slower than the baseline by more
+// than thresholdPercent
+bool Benchmark::compareToBaseline(double thresholdPercent) const {
+    cout << "\n>> Baseline Comparison (threshold " << fixed << setprecision(1) << thresholdPercent << "%):\n";
+    cout << string(70, '-') << "\n";
+
+    bool ok = true;
+    for (const TestResult& r : results) {
+        auto it = baseline.find(r.testName);
+        if (it == baseline.end() || it->second <= 0) {
+            cout << left << setw(40) << r.testName << "(no baseline)\n";
+            continue;
+        }
+
+        double change = (r.timeMs - it->second) / it->second * 100.0;
+        bool regressed = change > thresholdPercent;
+        if (regressed) ok = false;
+        cout << left << setw(40) << r.testName << right << setw(9) << setprecision(1)
+            << showpos << change << noshowpos << "%  " << (regressed ? "[REGRESSION]" : "[OK]") << "\n";
+    }
+
+    cout << string(70, '-') << "\n";
+    return ok;
 }
 
 void Benchmark::clearResults() {
@@ -66,18 +498,33 @@ unsigned long long fibMemoized(int n, map<int, unsigned long long>& memo) {
     return memo[n];
 }
 
+// Reference value the timed variants are checked against
+unsigned long long fibIterative(int n) {
+    unsigned long long a = 0, b = 1;
+    for (int i = 0; i < n; i++) {
+        unsigned long long next = a + b;
+        a = b;
+        b = next;
+    }
+    return a;
+}
+
 void Benchmark::testRecursiveFibonacci(int n) {
-    runTest("Recursive Fibonacci(" + to_string(n) + ")", [n]() {
-        fibRecursive(n);
-        return true;
+    unsigned long long expected = fibIterative(n);
+    runTest("Recursive Fibonacci(" + to_string(n) + ")", [n, expected]() {
+        unsigned long long value = fibRecursive(n);
+        doNotOptimize(value);
+        return value == expected;
         });
 }
 
 void Benchmark::testMemoizedFibonacci(int n) {
-    runTest("Memoized Fibonacci(" + to_string(n) + ")", [n]() {
+    unsigned long long expected = fibIterative(n);
+    runTest("Memoized Fibonacci(" + to_string(n) + ")", [n, expected]() {
         map<int, unsigned long long> memo;
-        fibMemoized(n, memo);
-        return true;
+        unsigned long long value = fibMemoized(n, memo);
+        doNotOptimize(value);
+        return value == expected;
         });
 }
 
@@ -87,9 +534,13 @@ unsigned long long factorialRecursive(int n) {
 }
 
 void Benchmark::testFactorial(int n) {
-    runTest("Factorial(" + to_string(n) + ")", [n]() {
-        factorialRecursive(n);
-        return true;
+    unsigned long long expected = 1;
+    for (int i = 2; i <= n; i++) expected *= i;
+
+    runTest("Factorial(" + to_string(n) + ")", [n, expected]() {
+        unsigned long long value = factorialRecursive(n);
+        doNotOptimize(value);
+        return value == expected;
         });
 }
 
@@ -100,9 +551,14 @@ unsigned long long nCrRecursive(int n, int r) {
 }
 
 void Benchmark::testCombinations(int n, int r) {
-    runTest("Combinations C(" + to_string(n) + "," + to_string(r) + ")", [n, r]() {
-        nCrRecursive(n, r);
-        return true;
+    // Multiplicative formula; each partial product is itself a binomial coefficient
+    unsigned long long expected = 1;
+    for (int i = 1; i <= r; i++) expected = expected * (n - r + i) / i;
+
+    runTest("Combinations C(" + to_string(n) + "," + to_string(r) + ")", [n, r, expected]() {
+        unsigned long long value = nCrRecursive(n, r);
+        doNotOptimize(value);
+        return value == expected;
         });
 }
 
@@ -122,6 +578,71 @@ void Benchmark::testPowerSet(int n) {
         vector<int> current;
         int count = 0;
         generatePowerSetRecursive(0, n, current, count);
-        return true;
+        doNotOptimize(count);
+        return count == (1 << n);
+        });
+}
+
+void Benchmark::testDurableRegistrations(int count) {
+    const string path = "bench_registrations.wal";
+    auto freshLog = [&path]() {
+        remove(path.c_str());
+        remove((path + ".snap").c_str());
+    };
+
+    // Acknowledged path: every approved registration is committed first
+    runTest("Acknowledged registrations(" + to_string(count) + ")", [count, &freshLog, &path]() {
+        // Start every run from an empty log so repetitions do not replay each other
+        freshLog();
+        QuietOutput quiet;
+        ConsistencyChecker checker;
+        if (!checker.enableDurability(path)) return false;
+        for (int i = 0; i < count; i++) {
+            if (!checker.enrollStudentInCourse("S" + to_string(i), "C" + to_string(i % 500),
+                "T" + to_string(i % 40))) return false;
+        }
+        return checker.isDurable();
+        });
+    double ackedMs = results.back().timeMs;
+
+    // Same requests acknowledged in batches that share one commit each
+    const int batchSize = 100;
+    runTest("Batched acknowledged registrations(" + to_string(count) + ")", [count, batchSize, &freshLog, &path]() {
+        freshLog();
+        QuietOutput quiet;
+        ConsistencyChecker checker;
+        if (!checker.enableDurability(path)) return false;
+        vector<Enrollment> batch;
+        for (int i = 0; i < count; i++) {
+            batch.push_back({ "S" + to_string(i), "C" + to_string(i % 500), "T" + to_string(i % 40) });
+            if ((int)batch.size() == batchSize || i == count - 1) {
+                vector<bool> approved = checker.enrollStudentsInCourses(batch);
+                if (find(approved.begin(), approved.end(), false) != approved.end()) return false;
+                batch.clear();
+            }
+        }
+        return checker.isDurable();
+        });
+    double batchedMs = results.back().timeMs;
+
+    // Bulk loading: group committed, then synced once at the end
+    runTest("Bulk durable registrations(" + to_string(count) + ")", [count, &freshLog, &path]() {
+        freshLog();
+        ConsistencyChecker checker;
+        if (!checker.enableDurability(path)) return false;
+        for (int i = 0; i < count; i++) {
+            checker.addEnrollment("S" + to_string(i % 1000), "C" + to_string(i),
+                "T" + to_string(i % 40));
+        }
+        return checker.syncLog();
         });
-}
\ No newline at end of file
+    double bulkMs = results.back().timeMs;
+
+    freshLog();
+
+    cout << fixed << setprecision(0);
+    if (ackedMs > 0) cout << "  Acknowledged: " << count / (ackedMs / 1000.0) << " registrations/sec\n";
+    if (batchedMs > 0) cout << "  Batched (" << batchSize << "/commit): " << count / (batchedMs / 1000.0) << " registrations/sec\n";
+    if (bulkMs > 0) cout << "  Bulk: " << count / (bulkMs / 1000.0) << " registrations/sec\n";
+    cout << setprecision(3);
+}
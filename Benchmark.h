@@ -5,43 +5,124 @@
 #include <chrono>
 #include <functional>
 #include <vector>
+#include <map>
+#include <memory>
+#include "PerfCounters.h"
+#include "AllocationTracker.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+struct BenchmarkOptions {
+    int warmupIterations = 1;
+    int minRepetitions = 5;
+    int maxRepetitions = 1000;
+    double minTotalMs = 200.0;  // keep repeating until this much time was measured
+};
+
+// Volatile sink for doNotOptimize where inline asm is unavailable
+inline volatile char benchmarkSink = 0;
 
 class Benchmark {
 private:
     struct TestResult {
         std::string testName;
-        double timeMs;
+        double timeMs;      // median wall time of one run
         bool passed;
+        int repetitions;
+        double minMs;
+        double meanMs;
+        double stddevMs;
+        double p99Ms;
+        double cpuMs;       // median CPU time of one run
+        bool hasCounters;
+        double counters[PerfCounters::EventCount];  // per run, negative if unavailable
+        bool hasAllocations;
+        double allocationsPerRun;
+        double bytesPerRun;
+        unsigned long long peakLiveBytes;  // highest over all runs of the test
+        std::vector<AllocationSite> topSites;
     };
 
+    BenchmarkOptions options;
     std::vector<TestResult> results;
+    std::map<std::string, double> baseline;
+    std::unique_ptr<PerfCounters> perf;
+    bool trackAllocations;
+    int allocationSampleEvery;
 
 public:
     Benchmark();
+    explicit Benchmark(const BenchmarkOptions& opts);
 
     template<typename Func>
     double measureTime(Func func);
 
+    // Keeps a computed value alive so the optimizer cannot delete the work
+    template<typename T>
+    static void doNotOptimize(const T& value);
+
+    void setOptions(const BenchmarkOptions& opts) { options = opts; }
+    // Records hardware counters next to the timings of every following test
+    void enablePerfCounters(bool enable);
+    // Counts allocations per test; needs a build with BENCHMARK_TRACK_ALLOCATIONS.
+    // sampleEvery > 0 also attributes every Nth allocation to its call site.
+    void enableAllocationTracking(bool enable, int sampleEvery = 0);
     void runTest(const std::string& name, std::function<bool()> testFunc);
+
+    // Runs makeTest(n) for each size (setup untimed, returned closure timed),
+    // then fits the medians to c*n^k and c*b^n and reports the better fit.
+    // Returns the fitted polynomial exponent k.
+    double runScaling(const std::string& name, const std::vector<int>& sizes,
+        std::function<std::function<bool()>(int)> makeTest);
+
     void displayResults() const;
     void clearResults();
 
+    // Machine-readable output and regression gating against a saved CSV run
+    bool exportJSON(const std::string& path) const;
+    bool exportCSV(const std::string& path) const;
+    bool loadBaseline(const std::string& csvPath);
+    bool compareToBaseline(double thresholdPercent) const;
+
     // Algorithmic efficiency tests
     void testRecursiveFibonacci(int n);
     void testMemoizedFibonacci(int n);
     void testFactorial(int n);
     void testCombinations(int n, int r);
     void testPowerSet(int n);
+
+    // Scaling sweeps over generated catalogs and populations
+    void testScalingSuite(unsigned long long seed);
+
+    // Registration throughput with the mutation log enabled, acknowledged and bulk
+    void testDurableRegistrations(int count);
 };
 
 // Template implementation
 template<typename Func>
 double Benchmark::measureTime(Func func) {
-    auto start = std::chrono::high_resolution_clock::now();
+    auto start = std::chrono::steady_clock::now();
     func();
-    auto end = std::chrono::high_resolution_clock::now();
+    auto end = std::chrono::steady_clock::now();
     std::chrono::duration<double, std::milli> duration = end - start;
     return duration.count();
 }
 
-#endif
\ No newline at end of file
+template<typename T>
+void Benchmark::doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    // A volatile read of the object forces it to be materialised, and the
+    // barrier keeps the compiler (LTCG included) from reordering memory
+    // accesses around it; an opaque call would be inlined under LTCG
+    benchmarkSink = reinterpret_cast<const volatile char&>(value);
+#ifdef _MSC_VER
+    _ReadWriteBarrier();
+#endif
+#endif
+}
+
+#endif
@@ -1,10 +1,11 @@
 ﻿#include "ConsistencyChecker.h"
+#include "Instrumentation.h"
 #include <iostream>
 #include <algorithm>
 
 using namespace std;
 
-ConsistencyChecker::ConsistencyChecker() {}
+ConsistencyChecker::ConsistencyChecker() : replaying(false), logFailureReported(false) {}
 
 // Student course management with prerequisite checking
 bool ConsistencyChecker::enrollStudentInCourse(const string& student, const string& course,
@@ -23,15 +24,7 @@ bool ConsistencyChecker::enrollStudentInCourse(const string& student, const stri
         if (prerequisites.count(course)) {
             cout << "Required prerequisites for " << course << ":\n";
             for (const string& prereq : prerequisites[course]) {
-                bool completed = false;
-                if (studentCompletedCourses.count(student)) {
-                    for (const string& comp : studentCompletedCourses[student]) {
-                        if (comp == prereq) {
-                            completed = true;
-                            break;
-                        }
-                    }
-                }
+                bool completed = hasCompleted(student, prereq);
                 cout << "  -> " << prereq << (completed ? " [COMPLETED]" : " [MISSING]") << "\n";
             }
         }
@@ -39,16 +32,19 @@ bool ConsistencyChecker::enrollStudentInCourse(const string& student, const stri
     }
 
     // Check for time conflicts
-    for (const Enrollment& e : enrollments) {
-        if (e.studentId == student && e.timeSlot == timeSlot) {
-            cout << "[DENIED] Schedule conflict detected with " << e.courseId << "!\n";
-            return false;
-        }
+    if (const Enrollment* clash = findScheduleConflict(student, timeSlot)) {
+        cout << "[DENIED] Schedule conflict detected with " << clash->courseId << "!\n";
+        return false;
+    }
+
+    // Write-ahead: the registration is on disk before it is approved
+    if (!logMutation(LogRecord::Enroll, student, course, timeSlot) || !commitLog()) {
+        cout << "[DENIED] Registration could not be recorded!\n";
+        return false;
     }
 
     // Enroll student
-    enrollments.push_back({ student, course, timeSlot });
-    studentCourses[student].push_back(course);
+    recordEnrollment(student, course, timeSlot);
 
     cout << "[APPROVED] Registration successful!\n";
     cout << "---------------------------------------\n";
@@ -56,11 +52,87 @@ bool ConsistencyChecker::enrollStudentInCourse(const string& student, const stri
     return true;
 }
 
+vector<bool> ConsistencyChecker::enrollStudentsInCourses(const vector<Enrollment>& requests) {
+    cout << "\n>> Processing " << requests.size() << " Registration Requests:\n";
+    cout << "---------------------------------------\n";
+
+    vector<bool> approved(requests.size(), false);
+    vector<string> reasons(requests.size());
+    set<pair<string, string>> batchSlots;  // student + slot approved earlier in this batch
+
+    for (size_t i = 0; i < requests.size(); i++) {
+        const Enrollment& r = requests[i];
+        if (!hasCompletedPrerequisites(r.studentId, r.courseId)) {
+            reasons[i] = "Missing required prerequisites";
+        } else if (const Enrollment* clash = findScheduleConflict(r.studentId, r.timeSlot)) {
+            reasons[i] = "Schedule conflict with " + clash->courseId;
+        } else if (!batchSlots.emplace(r.studentId, r.timeSlot).second) {
+            reasons[i] = "Schedule conflict within batch";
+        } else if (!logMutation(LogRecord::Enroll, r.studentId, r.courseId, r.timeSlot)) {
+            reasons[i] = "Registration could not be recorded";
+        } else {
+            approved[i] = true;
+        }
+    }
+
+    // One commit (one fsync under SyncPolicy::EveryCommit) acknowledges the batch
+    if (!commitLog()) {
+        for (size_t i = 0; i < requests.size(); i++) {
+            if (approved[i]) {
+                approved[i] = false;
+                reasons[i] = "Registration could not be recorded";
+            }
+        }
+    }
+
+    for (size_t i = 0; i < requests.size(); i++) {
+        const Enrollment& r = requests[i];
+        if (approved[i]) {
+            recordEnrollment(r.studentId, r.courseId, r.timeSlot);
+            cout << "[APPROVED] " << r.studentId << " -> " << r.courseId << " @ " << r.timeSlot << "\n";
+        } else {
+            cout << "[DENIED] " << r.studentId << " -> " << r.courseId << ": " << reasons[i] << "\n";
+        }
+    }
+    cout << "---------------------------------------\n";
+
+    return approved;
+}
+
 void ConsistencyChecker::markCourseCompleted(const string& student, const string& course) {
-    studentCompletedCourses[student].push_back(course);
+    if (!logMutation(LogRecord::Complete, student, course) || !commitLog()) {
+        cout << "[ERROR] Completion could not be recorded: " << course << " for " << student << "\n";
+        return;
+    }
+    recordCompletion(student, course);
     cout << "[OK] Recorded completion: " << course << " for " << student << "\n";
 }
 
+void ConsistencyChecker::recordCompletion(const string& student, const string& course) {
+    studentCompletedCourses[student].push_back(course);
+    registerCourse(course);
+
+    if (completedSet[student].insert(course).second) {
+        completedBy[course].push_back(student);
+        unlockedCourses[student].erase(course);
+
+        // Only the courses that list this one as a prerequisite can change state
+        auto deps = dependents.find(course);
+        if (deps != dependents.end()) {
+            unordered_map<string, int>& counters = unmetPrereqs[student];
+            for (const string& dep : deps->second) {
+                auto counter = counters.find(dep);
+                if (counter == counters.end()) {
+                    recountUnmet(student, dep);
+                }
+                else if (--counter->second == 0 && !hasCompleted(student, dep)) {
+                    unlockedCourses[student].insert(dep);
+                }
+            }
+        }
+    }
+}
+
 void ConsistencyChecker::displayStudentCourses(const string& student) const {
     cout << "\n>> Academic Record for: " << student << "\n";
     cout << "---------------------------------------\n";
@@ -95,54 +167,258 @@ void ConsistencyChecker::displayStudentCourses(const string& student) const {
 }
 
 bool ConsistencyChecker::hasCompletedPrerequisites(const string& student, const string& course) const {
-    if (!prerequisites.count(course)) {
+    auto prereqs = prerequisites.find(course);
+    if (prereqs == prerequisites.end() || prereqs->second.empty()) {
         return true; // No prerequisites required
     }
 
-    // Check each prerequisite
-    for (const string& prereq : prerequisites.at(course)) {
-        bool found = false;
+    // No counter yet means the student has not completed any prerequisite of this course
+    auto counters = unmetPrereqs.find(student);
+    if (counters == unmetPrereqs.end()) return false;
+    auto counter = counters->second.find(course);
+    if (counter == counters->second.end()) return false;
 
-        if (studentCompletedCourses.count(student)) {
-            for (const string& completed : studentCompletedCourses.at(student)) {
-                if (completed == prereq) {
-                    found = true;
-                    break;
-                }
-            }
+    return counter->second == 0;
+}
+
+bool ConsistencyChecker::hasCompleted(const string& student, const string& course) const {
+    auto it = completedSet.find(student);
+    return it != completedSet.end() && it->second.count(course) > 0;
+}
+
+void ConsistencyChecker::registerCourse(const string& course) {
+    if (knownCourses.insert(course).second && !prerequisites.count(course)) {
+        rootCourses.insert(course);
+    }
+}
+
+// Rebuilds one student's counter for a course from scratch, O(prerequisites of course)
+void ConsistencyChecker::recountUnmet(const string& student, const string& course) {
+    int unmet = 0;
+    auto prereqs = prerequisites.find(course);
+    if (prereqs != prerequisites.end()) {
+        for (const string& prereq : prereqs->second) {
+            if (!hasCompleted(student, prereq)) unmet++;
         }
+    }
 
-        if (!found) {
-            return false; // Missing prerequisite
+    auto counter = unmetPrereqs[student].emplace(course, unmet);
+    if (counter.second) countedStudents[course].push_back(student);
+    else counter.first->second = unmet;
+    if (unmet == 0 && !hasCompleted(student, course)) {
+        unlockedCourses[student].insert(course);
+    }
+    else {
+        unlockedCourses[student].erase(course);
+    }
+}
+
+vector<string> ConsistencyChecker::eligibleCourses(const string& student) const {
+    vector<string> eligible;
+    auto completed = completedSet.find(student);
+    auto enrolled = enrolledSet.find(student);
+    auto isEnrolled = [&enrolled, this](const string& course) {
+        return enrolled != enrolledSet.end() && enrolled->second.count(course) > 0;
+    };
+
+    for (const string& course : rootCourses) {
+        if (isEnrolled(course)) continue;
+        if (completed == completedSet.end() || !completed->second.count(course)) {
+            eligible.push_back(course);
         }
     }
 
-    return true; // All prerequisites completed
+    auto unlocked = unlockedCourses.find(student);
+    if (unlocked != unlockedCourses.end()) {
+        for (const string& course : unlocked->second) {
+            if (!isEnrolled(course)) eligible.push_back(course);
+        }
+    }
+    return eligible;
 }
 
-void ConsistencyChecker::addEnrollment(const string& student, const string& course,
+void ConsistencyChecker::recordEnrollment(const string& student, const string& course,
     const string& timeSlot) {
     enrollments.push_back({ student, course, timeSlot });
     studentCourses[student].push_back(course);
+    enrolledSet[student].insert(course);
+    registerCourse(course);
+}
+
+void ConsistencyChecker::addEnrollment(const string& student, const string& course,
+    const string& timeSlot) {
+    recordEnrollment(student, course, timeSlot);
+    logMutation(LogRecord::Enroll, student, course, timeSlot);
 }
 
 void ConsistencyChecker::addAssignment(const string& faculty, const string& course,
     const string& room) {
     assignments.push_back({ faculty, course, room });
+    registerCourse(course);
+    logMutation(LogRecord::Assign, faculty, course, room);
 }
 
 void ConsistencyChecker::addPrerequisite(const string& course, const string& prereq) {
-    prerequisites[course].push_back(prereq);
+    vector<string>& prereqs = prerequisites[course];
+    if (find(prereqs.begin(), prereqs.end(), prereq) != prereqs.end()) return;
+
+    prereqs.push_back(prereq);
+    dependents[prereq].push_back(course);
+    rootCourses.erase(course);
+    registerCourse(course);
+    registerCourse(prereq);
+    logMutation(LogRecord::Prereq, course, prereq);
+
+    // Only students whose counter for this course exists, or who already completed
+    // the new prerequisite before it was declared, can change state
+    auto tracked = countedStudents.find(course);
+    if (tracked != countedStudents.end()) {
+        for (const string& student : tracked->second) recountUnmet(student, course);
+    }
+    auto done = completedBy.find(prereq);
+    if (done != completedBy.end()) {
+        for (const string& student : done->second) recountUnmet(student, course);
+    }
+}
+
+void ConsistencyChecker::addCourse(const string& course) {
+    if (knownCourses.count(course)) return;
+    registerCourse(course);
+    logMutation(LogRecord::Course, course, "");
 }
 
 void ConsistencyChecker::addCourseCredit(const string& course, int credits) {
     courseCredits[course] = credits;
+    registerCourse(course);
+    logMutation(LogRecord::Credit, course, "", "", credits);
+}
+
+bool ConsistencyChecker::logMutation(LogRecord::Type type, const string& a, const string& b,
+    const string& c, int value) {
+    if (logPath.empty() || replaying) return true;
+    if (mutationLog && mutationLog->append({ type, a, b, c, value })) return true;
+    reportLogFailure();
+    return false;
+}
+
+bool ConsistencyChecker::commitLog() {
+    if (logPath.empty() || replaying) return true;
+    if (mutationLog && mutationLog->commit()) return true;
+    reportLogFailure();
+    return false;
+}
+
+void ConsistencyChecker::reportLogFailure() {
+    if (logFailureReported) return;
+    logFailureReported = true;
+    cout << "[ERROR] Mutation log " << logPath << " cannot be written - changes are no longer durable\n";
+}
+
+void ConsistencyChecker::applyRecord(const LogRecord& record) {
+    switch (record.type) {
+    case LogRecord::Enroll:   addEnrollment(record.a, record.b, record.c); break;
+    case LogRecord::Assign:   addAssignment(record.a, record.b, record.c); break;
+    case LogRecord::Complete: recordCompletion(record.a, record.b); break;
+    case LogRecord::Prereq:   addPrerequisite(record.a, record.b); break;
+    case LogRecord::Credit:   addCourseCredit(record.a, record.value); break;
+    case LogRecord::Course:   addCourse(record.a); break;
+    }
+}
+
+bool ConsistencyChecker::enableDurability(const string& path, const LogOptions& options) {
+    logPath = path;
+    string snapshotPath = path + ".snap";
+    auto apply = [this](const LogRecord& record) { applyRecord(record); };
+
+    replaying = true;
+    unsigned long long snapshotGen = 0;
+    long long validBytes = 0;
+    MutationLog::replay(snapshotPath, snapshotGen, apply, validBytes);
+
+    // A log older than the snapshot was already folded into it by compaction
+    unsigned long long logGen = 0;
+    bool logUsable = MutationLog::readGeneration(path, logGen) && logGen >= snapshotGen;
+    if (logUsable) {
+        MutationLog::replay(path, logGen, apply, validBytes);
+        MutationLog::truncate(path, validBytes);
+    }
+    else {
+        logGen = snapshotGen;
+        MutationLog::writeFile(path, logGen, {});
+    }
+    replaying = false;
+
+    mutationLog.reset(new MutationLog());
+    if (!mutationLog->open(path, options, logGen)) {
+        cout << "[ERROR] Could not open mutation log: " << path << "\n";
+        mutationLog.reset();
+        logPath.clear();
+        return false;
+    }
+    logFailureReported = false;
+    return true;
+}
+
+bool ConsistencyChecker::syncLog() {
+    if (logPath.empty()) return true;
+    if (mutationLog && mutationLog->sync()) return true;
+    reportLogFailure();
+    return false;
+}
+
+// Rewrites the current state as a snapshot and starts a fresh, empty log
+bool ConsistencyChecker::compactLog() {
+    if (!syncLog() || !mutationLog) return false;
+
+    vector<LogRecord> records;
+    for (const string& course : knownCourses) {
+        records.push_back({ LogRecord::Course, course, "", "", 0 });
+    }
+    for (const auto& pair : prerequisites) {
+        for (const string& prereq : pair.second) {
+            records.push_back({ LogRecord::Prereq, pair.first, prereq, "", 0 });
+        }
+    }
+    for (const auto& pair : courseCredits) {
+        records.push_back({ LogRecord::Credit, pair.first, "", "", pair.second });
+    }
+    for (const Assignment& a : assignments) {
+        records.push_back({ LogRecord::Assign, a.facultyId, a.courseId, a.roomId, 0 });
+    }
+    for (const Enrollment& e : enrollments) {
+        records.push_back({ LogRecord::Enroll, e.studentId, e.courseId, e.timeSlot, 0 });
+    }
+    for (const auto& pair : studentCompletedCourses) {
+        for (const string& course : pair.second) {
+            records.push_back({ LogRecord::Complete, pair.first, course, "", 0 });
+        }
+    }
+
+    unsigned long long gen = mutationLog->getGeneration() + 1;
+    if (!MutationLog::writeFile(logPath + ".snap", gen, records)) return false;
+
+    // The snapshot now supersedes the old log, so appending to it would be lost
+    // on restart; without a fresh log every later mutation reports a failure
+    if (!mutationLog->reset(gen)) {
+        reportLogFailure();
+        return false;
+    }
+    return true;
+}
+
+const Enrollment* ConsistencyChecker::findScheduleConflict(const string& student,
+    const string& timeSlot) const {
+    for (const Enrollment& e : enrollments) {
+        if (e.studentId == student && e.timeSlot == timeSlot) return &e;
+    }
+    return nullptr;
 }
 
 bool ConsistencyChecker::hasTimeConflict(const string& student) const {
     vector<string> timeSlots;
 
     for (const Enrollment& e : enrollments) {
+        STATS_SCAN(PhaseTimeConflicts);
         if (e.studentId == student) {
             for (const string& slot : timeSlots) {
                 if (slot == e.timeSlot) return true;
@@ -159,8 +435,10 @@ bool ConsistencyChecker::hasRoomConflict() const {
             if (assignments[i].roomId == assignments[j].roomId) {
                 // Same room - check if times conflict
                 for (const Enrollment& e1 : enrollments) {
+                    STATS_SCAN(PhaseRoomConflicts);
                     if (e1.courseId == assignments[i].courseId) {
                         for (const Enrollment& e2 : enrollments) {
+                            STATS_SCAN(PhaseRoomConflicts);
                             if (e2.courseId == assignments[j].courseId) {
                                 if (e1.timeSlot == e2.timeSlot) {
                                     return true;
@@ -181,8 +459,10 @@ bool ConsistencyChecker::hasFacultyConflict() const {
             if (assignments[i].facultyId == assignments[j].facultyId) {
                 // Same faculty - check if times conflict
                 for (const Enrollment& e1 : enrollments) {
+                    STATS_SCAN(PhaseFacultyConflicts);
                     if (e1.courseId == assignments[i].courseId) {
                         for (const Enrollment& e2 : enrollments) {
+                            STATS_SCAN(PhaseFacultyConflicts);
                             if (e2.courseId == assignments[j].courseId) {
                                 if (e1.timeSlot == e2.timeSlot) {
                                     return true;
@@ -198,6 +478,7 @@ bool ConsistencyChecker::hasFacultyConflict() const {
 }
 
 bool ConsistencyChecker::checkPrerequisites() {
+    STATS_PHASE_TIMER(PhasePrerequisites);
     cout << "\n=== Checking Prerequisites ===\n";
     bool valid = true;
 
@@ -210,6 +491,7 @@ bool ConsistencyChecker::checkPrerequisites() {
                 for (const string& prereq : prerequisites[course]) {
                     bool found = false;
                     for (const string& taken : courses) {
+                        STATS_SCAN(PhasePrerequisites);
                         if (taken == prereq) {
                             found = true;
                             break;
@@ -230,6 +512,7 @@ bool ConsistencyChecker::checkPrerequisites() {
 }
 
 bool ConsistencyChecker::checkTimeConflicts() {
+    STATS_PHASE_TIMER(PhaseTimeConflicts);
     cout << "\n=== Checking Time Conflicts ===\n";
     bool valid = true;
 
@@ -245,6 +528,7 @@ bool ConsistencyChecker::checkTimeConflicts() {
 }
 
 bool ConsistencyChecker::checkRoomConflicts() {
+    STATS_PHASE_TIMER(PhaseRoomConflicts);
     cout << "\n=== Checking Room Conflicts ===\n";
 
     if (hasRoomConflict()) {
@@ -257,6 +541,7 @@ bool ConsistencyChecker::checkRoomConflicts() {
 }
 
 bool ConsistencyChecker::checkFacultyConflicts() {
+    STATS_PHASE_TIMER(PhaseFacultyConflicts);
     cout << "\n=== Checking Faculty Conflicts ===\n";
 
     if (hasFacultyConflict()) {
@@ -269,12 +554,14 @@ bool ConsistencyChecker::checkFacultyConflicts() {
 }
 
 bool ConsistencyChecker::checkCreditOverload(int maxCredits) {
+    STATS_PHASE_TIMER(PhaseCreditOverload);
     cout << "\n=== Checking Credit Overload ===\n";
     bool valid = true;
 
     for (const auto& pair : studentCourses) {
         int totalCredits = 0;
         for (const string& course : pair.second) {
+            STATS_SCAN(PhaseCreditOverload);
             if (courseCredits.count(course)) {
                 totalCredits += courseCredits[course];
             }
@@ -292,6 +579,7 @@ bool ConsistencyChecker::checkCreditOverload(int maxCredits) {
 }
 
 bool ConsistencyChecker::checkAll() {
+    STATS_COUNT(StatCheckRuns);
     cout << "\n|-----------------------------------|\n";
     cout << "|   CONSISTENCY CHECK REPORT        |\n";
     cout << "|------------------------------------|\n";
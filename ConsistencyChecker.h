@@ -1,9 +1,14 @@
 #ifndef CONSISTENCYCHECKER_H
 #define CONSISTENCYCHECKER_H
 
+#include "MutationLog.h"
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
 
 struct Enrollment {
     std::string studentId;
@@ -26,6 +31,43 @@ private:
     std::map<std::string, std::vector<std::string>> studentCompletedCourses;
     std::map<std::string, int> courseCredits;
 
+    // Eligibility index: prerequisite -> courses that require it, plus per-student
+    // counters of still-unmet prerequisites so completions update in O(out-degree).
+    std::set<std::string> knownCourses;
+    std::set<std::string> rootCourses;
+    std::unordered_map<std::string, std::vector<std::string>> dependents;
+    std::unordered_map<std::string, std::unordered_set<std::string>> completedSet;
+    std::unordered_map<std::string, std::unordered_map<std::string, int>> unmetPrereqs;
+    std::unordered_map<std::string, std::set<std::string>> unlockedCourses;
+    std::unordered_map<std::string, std::unordered_set<std::string>> enrolledSet;
+    // Per course: students who completed it, and students holding a counter for
+    // it, so a new prerequisite edge only revisits the students it can affect
+    std::unordered_map<std::string, std::vector<std::string>> completedBy;
+    std::unordered_map<std::string, std::vector<std::string>> countedStudents;
+
+    // Durability: every mutation is appended to the log unless it is being replayed
+    std::unique_ptr<MutationLog> mutationLog;
+    std::string logPath;
+    bool replaying;
+    bool logFailureReported;
+
+    // Returns false (and reports once) if durability is enabled but the log
+    // cannot take the record
+    bool logMutation(LogRecord::Type type, const std::string& a, const std::string& b,
+        const std::string& c = "", int value = 0);
+    bool commitLog();
+    void reportLogFailure();
+    void applyRecord(const LogRecord& record);
+    void recordCompletion(const std::string& student, const std::string& course);
+    void recordEnrollment(const std::string& student, const std::string& course,
+        const std::string& timeSlot);
+
+    void registerCourse(const std::string& course);
+    bool hasCompleted(const std::string& student, const std::string& course) const;
+    void recountUnmet(const std::string& student, const std::string& course);
+
+    const Enrollment* findScheduleConflict(const std::string& student,
+        const std::string& timeSlot) const;
     bool hasTimeConflict(const std::string& student) const;
     bool hasRoomConflict() const;
     bool hasFacultyConflict() const;
@@ -34,19 +76,41 @@ private:
 public:
     ConsistencyChecker();
 
-    // Student course management
+    // Student course management. With durability enabled each call commits its
+    // record before acknowledging it, so under SyncPolicy::EveryCommit throughput
+    // is bounded by the device's fsync rate (about one call per fsync).
     bool enrollStudentInCourse(const std::string& student, const std::string& course,
         const std::string& timeSlot);
+    // Validates the requests in order (a request also conflicts with earlier
+    // approved ones in the batch) and acknowledges all approvals with one commit.
+    // If that commit fails nothing is applied and every request is denied.
+    std::vector<bool> enrollStudentsInCourses(const std::vector<Enrollment>& requests);
     void markCourseCompleted(const std::string& student, const std::string& course);
     void displayStudentCourses(const std::string& student) const;
+    // Courses the student may take next: prerequisites met, not completed and not
+    // currently enrolled. O(root courses + unlocked courses).
+    std::vector<std::string> eligibleCourses(const std::string& student) const;
 
     void addEnrollment(const std::string& student, const std::string& course,
         const std::string& timeSlot);
     void addAssignment(const std::string& faculty, const std::string& course,
         const std::string& room);
     void addPrerequisite(const std::string& course, const std::string& prereq);
+    // Registers a catalog course that may have no prerequisites, enrollments
+    // or assignments yet
+    void addCourse(const std::string& course);
     void addCourseCredit(const std::string& course, int credits);
 
+    // Replays snapshot + log from disk, then logs all further mutations.
+    // Call on a freshly constructed checker at startup. Registrations and
+    // completions are committed before they are acknowledged (batch them with
+    // enrollStudentsInCourses to share one commit); bulk add* calls are group
+    // committed within LogOptions::maxCommitDelayMs.
+    bool enableDurability(const std::string& path, const LogOptions& options = LogOptions());
+    bool isDurable() const { return mutationLog && mutationLog->isOpen(); }
+    bool syncLog();
+    bool compactLog();
+
     bool checkAll();
     bool checkPrerequisites();
     bool checkTimeConflicts();
@@ -54,6 +118,11 @@ public:
     bool checkFacultyConflicts();
     bool checkCreditOverload(int maxCredits);
 
+    const std::vector<Enrollment>& getEnrollments() const { return enrollments; }
+    int getCourseCount() const { return (int)knownCourses.size(); }
+    bool hasCourse(const std::string& course) const { return knownCourses.count(course) > 0; }
+    const std::vector<Assignment>& getAssignments() const { return assignments; }
+
     void displayReport() const;
     void displayEnrollments() const;
     void displayAssignments() const;
@@ -1,4 +1,5 @@
 #include "CourseGraph.h"
+#include "Instrumentation.h"
 #include <iostream>
 #include <algorithm>
 
@@ -10,10 +11,16 @@ CourseGraph::CourseGraph() {
 
 void CourseGraph::addCourse(const string& name) {
     if (name2idx.count(name)) return;
-    name2idx[name] = n++;
+    appendCourse(name);
+}
+
+// Adds a node even if the name is taken; the name keeps pointing at its first node
+int CourseGraph::appendCourse(const string& name) {
+    name2idx.emplace(name, n);
     idx2name.push_back(name);
     adj.push_back(vector<int>());
     indeg.push_back(0);
+    return n++;
 }
 
 void CourseGraph::addPrereq(const string& pre, const string& course) {
@@ -32,21 +39,29 @@ void CourseGraph::addEdge(int u, int v) {
     }
 }
 
-bool CourseGraph::dfsCycle(int u, vector<int>& state) const {
-    state[u] = 1;
-    for (int v : adj[u]) {
-        if (state[v] == 1) return true;
-        if (state[v] == 0 && dfsCycle(v, state)) return true;
-    }
-    state[u] = 2;
-    return false;
-}
-
+// Three-colour DFS with an explicit stack, so long chains cannot overflow
 bool CourseGraph::hasCycle() const {
     vector<int> state(n, 0);
+    vector<pair<int, size_t>> stack;
     for (int i = 0; i < n; i++) {
-        if (state[i] == 0 && dfsCycle(i, state))
-            return true;
+        if (state[i] != 0) continue;
+        state[i] = 1;
+        stack.push_back({ i, 0 });
+        while (!stack.empty()) {
+            int u = stack.back().first;
+            size_t& next = stack.back().second;
+            if (next == adj[u].size()) {
+                state[u] = 2;
+                stack.pop_back();
+                continue;
+            }
+            int v = adj[u][next++];
+            if (state[v] == 1) return true;
+            if (state[v] == 0) {
+                state[v] = 1;
+                stack.push_back({ v, 0 });
+            }
+        }
     }
     return false;
 }
@@ -54,11 +69,14 @@ bool CourseGraph::hasCycle() const {
 void CourseGraph::generateRecursive(vector<int>& current, vector<int>& current_indeg,
     vector<vector<int>>& results, unsigned long long cap) const
 {
+    STATS_DEPTH_SCOPE();
     if (results.size() >= cap) return;
     if ((int)current.size() == n) {
+        STATS_COUNT(StatSequencesGenerated);
         results.push_back(current);
         return;
     }
+    STATS_COUNT(StatStatesExpanded);
 
     for (int i = 0; i < n; i++) {
         if (current_indeg[i] == 0) {
@@ -87,13 +105,19 @@ string CourseGraph::encodeState(const vector<int>& indeg) const {
 }
 
 unsigned long long CourseGraph::countRecursive(vector<int>& indeg_state) {
+    STATS_DEPTH_SCOPE();
     string key = encodeState(indeg_state);
-    if (memo.count(key)) return memo[key];
+    if (memo.count(key)) {
+        STATS_COUNT(StatMemoHits);
+        return memo[key];
+    }
+    STATS_COUNT(StatMemoMisses);
 
     bool all_taken = true;
     for (int x : indeg_state) if (x != -1) all_taken = false;
     if (all_taken) return memo[key] = 1;
 
+    STATS_COUNT(StatStatesExpanded);
     unsigned long long ways = 0;
     for (int i = 0; i < n; i++) {
         if (indeg_state[i] == 0) {
@@ -115,7 +139,9 @@ unsigned long long CourseGraph::countRecursive(vector<int>& indeg_state) {
 unsigned long long CourseGraph::countSequences() {
     memo.clear();
     vector<int> indeg_copy = indeg;
-    return countRecursive(indeg_copy);
+    unsigned long long ways = countRecursive(indeg_copy);
+    STATS_SET(StatMemoEntries, memo.size());
+    return ways;
 }
 
 void CourseGraph::enumerateSequences(vector<vector<int>>& results, unsigned long long cap) {
@@ -125,6 +151,41 @@ void CourseGraph::enumerateSequences(vector<vector<int>>& results, unsigned long
     generateRecursive(curr, indeg_copy, results, cap);
 }
 
+CourseGraph CourseGraph::condensation(vector<int>* componentOf) const {
+    vector<int> component;
+    int count = stronglyConnectedComponents(component);
+
+    // Tarjan numbers components in reverse topological order
+    vector<vector<int>> members(count);
+    for (int v = 0; v < n; v++) {
+        component[v] = count - 1 - component[v];
+        members[component[v]].push_back(v);
+    }
+
+    CourseGraph dag;
+    for (int c = 0; c < count; c++) {
+        string name = idx2name[members[c][0]];
+        for (size_t i = 1; i < members[c].size(); i++) name += "+" + idx2name[members[c][i]];
+        dag.appendCourse(name);
+    }
+
+    // Parallel edges between two components are added once
+    vector<int> lastSource(count, -1);
+    for (int c = 0; c < count; c++) {
+        for (int u : members[c]) {
+            for (int v : adj[u]) {
+                int target = component[v];
+                if (target == c || lastSource[target] == c) continue;
+                lastSource[target] = c;
+                dag.addEdge(c, target);
+            }
+        }
+    }
+
+    if (componentOf) *componentOf = component;
+    return dag;
+}
+
 vector<string> CourseGraph::toNames(const vector<int>& seq) const {
     vector<string> out;
     for (int x : seq) out.push_back(idx2name[x]);
@@ -160,4 +221,25 @@ void CourseGraph::displayPrerequisites() const {
         cout << "  (No dependencies defined)\n";
     }
     cout << "---------------------------------------\n";
+}
+
+void CourseGraph::displayCycleGroups() const {
+    cout << "\n>> Circular Prerequisite Groups:\n";
+    cout << "---------------------------------------\n";
+    vector<CyclicGroup> groups = findCyclicGroups();
+    for (size_t g = 0; g < groups.size(); g++) {
+        cout << "  Group #" << g + 1 << " (" << groups[g].members.size() << " course(s)): ";
+        vector<string> names = toNames(groups[g].members);
+        for (size_t i = 0; i < names.size(); i++) {
+            cout << names[i];
+            if (i + 1 < names.size()) cout << ", ";
+        }
+        cout << "\n    Cycle: ";
+        for (int v : groups[g].witness) cout << idx2name[v] << " -> ";
+        cout << idx2name[groups[g].witness[0]] << "\n";
+    }
+    if (groups.empty()) {
+        cout << "  (No circular prerequisites)\n";
+    }
+    cout << "---------------------------------------\n";
 }
\ No newline at end of file
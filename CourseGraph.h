@@ -14,11 +14,11 @@ private:
     std::vector<int> indeg;
     std::map<std::string, unsigned long long> memo;
 
-    bool dfsCycle(int u, std::vector<int>& state) const;
     void generateRecursive(std::vector<int>& current, std::vector<int>& current_indeg,
         std::vector<std::vector<int>>& results, unsigned long long cap) const;
     std::string encodeState(const std::vector<int>& indeg) const;
     unsigned long long countRecursive(std::vector<int>& indeg_state);
+    int appendCourse(const std::string& name);
 
 public:
     CourseGraph();
@@ -28,10 +28,18 @@ public:
     bool hasCycle() const override;
     unsigned long long countSequences();
     void enumerateSequences(std::vector<std::vector<int>>& results, unsigned long long cap = 10000);
+    // DAG with each strongly connected component collapsed into one course named
+    // after its members joined by '+', in topological order. componentOf, if
+    // given, receives the condensed index of every original course. Nodes are
+    // added by index, so a group name that matches a real course name (e.g. an
+    // existing "A+B") still gets its own node; name lookups find the first one.
+    CourseGraph condensation(std::vector<int>* componentOf = nullptr) const;
     std::vector<std::string> toNames(const std::vector<int>& seq) const;
     void displayCourses() const;
     void displayPrerequisites() const;
+    void displayCycleGroups() const;
     int getCourseCount() const { return n; }
+    bool hasCourse(const std::string& name) const { return name2idx.count(name) > 0; }
 };
 
 #endif
\ No newline at end of file
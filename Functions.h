@@ -5,162 +5,925 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include <limits>
+#include <cstdint>
+#include <type_traits>
+#include <optional>
+#include <memory>
+#include <atomic>
+#include <numeric>
+
+// The dense backend indexes a flat array by id, so it needs unsigned integral
+// ids and is sized by the largest one. unsigned char and unsigned short use it
+// by default. Wider ids opt in per use with the explicit argument, e.g.
+// Functions<unsigned int, unsigned int, true> for ids renumbered 0..n-1; sparse
+// ids belong on the map backend.
+template <typename T>
+struct IsDenseId {
+    static const bool value = std::is_integral<T>::value && std::is_unsigned<T>::value &&
+        !std::is_same<T, bool>::value;
+};
+
+template <typename T>
+struct IsSmallId {
+    static const bool value = std::is_same<T, unsigned char>::value || std::is_same<T, unsigned short>::value;
+};
+
+// Value sets are hashed when std::hash<U> exists and ordered otherwise, so any
+// type usable as a map key still works
+template <typename U, typename = void>
+struct IsHashable : std::false_type {};
+
+template <typename U>
+struct IsHashable<U, std::void_t<decltype(std::hash<U>()(std::declval<const U&>()))>> : std::true_type {};
+
+template <typename U>
+using ValueSet = typename std::conditional<IsHashable<U>::value,
+    std::unordered_set<U>, std::set<U>>::type;
+
+template <typename U>
+void reserveValueSet(ValueSet<U>& values, size_t n) {
+    if constexpr (IsHashable<U>::value) values.reserve(n);
+}
 
 template <typename T, typename U>
-class Functions {
-private:
-    std::map<T, U> mapping;
+struct UseDenseMapping {
+    static const bool value = IsSmallId<T>::value && IsSmallId<U>::value;
+};
+
+// Cycle structure of a permutation. keys is the domain in ascending order and
+// a slot is an index into it; cycle i is cycleSlots[cycleStart[i] .. cycleStart[i + 1]).
+template <typename T>
+struct PermutationCycles {
+    std::vector<T> keys;
+    std::vector<size_t> cycleSlots;
+    std::vector<size_t> cycleStart;
+    unsigned long long order = 1;  // 0 if the lcm overflows
+    int sign = 1;
+
+    size_t cycleCount() const { return cycleStart.size() - 1; }
+    const T& element(size_t j) const { return keys[cycleSlots[j]]; }
+};
+
+// Walks every cycle once, O(n). next[s] is the slot of the image of keys[s], or
+// keys.size() if the image is outside the domain. Reaching a slot already
+// visited anywhere but the cycle's start means two inputs share an image, so
+// the function is not a permutation.
+template <typename T>
+std::shared_ptr<const PermutationCycles<T>> decomposeCycles(std::vector<T> keys,
+    const std::vector<size_t>& next) {
+    auto result = std::make_shared<PermutationCycles<T>>();
+    size_t n = keys.size();
+    result->keys = std::move(keys);
+    result->cycleSlots.reserve(n);
+    result->cycleStart.push_back(0);
+    std::vector<bool> visited(n, false);
+
+    for (size_t start = 0; start < n; start++) {
+        if (visited[start]) continue;
+
+        size_t s = start;
+        while (true) {
+            visited[s] = true;
+            result->cycleSlots.push_back(s);
+            s = next[s];
+            if (s >= n) throw std::runtime_error("Function is not a permutation");
+            if (s == start) break;
+            if (visited[s]) throw std::runtime_error("Function is not a permutation");
+        }
+
+        size_t length = result->cycleSlots.size() - result->cycleStart.back();
+        result->cycleStart.push_back(result->cycleSlots.size());
+        if (length % 2 == 0) result->sign = -result->sign;
+        if (result->order != 0) {
+            unsigned long long step = length / std::gcd(result->order, (unsigned long long)length);
+            if (result->order > std::numeric_limits<unsigned long long>::max() / step) result->order = 0;
+            else result->order *= step;
+        }
+    }
+    return result;
+}
+
+// Pass 1 of the dense compose: out[x] = image of in[x] and kept[x] = 1 when
+// in[x] is a defined slot of lookup. Out-of-range ids read slot 0 and are
+// masked off, so the body has no branches and no loop-carried state; with
+// __restrict the compiler can turn it into a vector gather (GCC -O3 with AVX2).
+template <typename U, typename V, typename Entry>
+void denseGather(const U* __restrict in, const Entry* __restrict lookup, size_t tableSize,
+    V* __restrict out, unsigned char* __restrict kept, size_t n) {
+    // lookup is indexed by U, so tableSize always fits the index type
+    typedef typename std::conditional<(sizeof(U) < 4), std::uint32_t, std::uint64_t>::type Index;
+    const Index limit = (Index)tableSize;
+    for (size_t x = 0; x < n; x++) {
+        Index y = in[x];
+        Index inRange = y < limit;
+        Entry e = lookup[y & (Index(0) - inRange)];
+        out[x] = (V)e;
+        kept[x] = (unsigned char)((e >> (sizeof(Entry) * 8 - 1)) & inRange);
+    }
+}
+
+template <typename Inner, typename Outer>
+class LazyComposition;
+
+// Everything both backends share: the domain and codomain in insertion order,
+// the property and cycle caches, and the queries built on them. Derived
+// supplies computeProperties() and buildCycles().
+//
+// Like the standard containers, const members may run concurrently but a
+// mutation needs exclusive access. The caches are filled lazily from const
+// members, so they are published atomically: racing readers may both compute
+// a value, and they all end up using the same one.
+template <typename Derived, typename T, typename U>
+class FunctionsBase {
+protected:
     std::vector<T> domain;
     std::vector<U> codomain;
 
+    struct Properties {
+        bool function;
+        bool injective;
+        bool surjective;
+    };
+
+    // Property flags, computed together in one O(n) pass and dropped on mutation.
+    // Bit 0 marks them valid; the flags depend only on the mapping, so relaxed
+    // ordering is enough.
+    struct PropertyCache {
+        std::atomic<unsigned char> bits{0};
+
+        PropertyCache() {}
+        PropertyCache(const PropertyCache& other) : bits(other.bits.load(std::memory_order_relaxed)) {}
+        PropertyCache& operator=(const PropertyCache& other) {
+            bits.store(other.bits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+    };
+
+    // Only touched through std::atomic_load / atomic_store / compare_exchange
+    struct CycleCache {
+        std::shared_ptr<const PermutationCycles<T>> cycles;
+
+        CycleCache() {}
+        CycleCache(const CycleCache& other) : cycles(std::atomic_load(&other.cycles)) {}
+        CycleCache& operator=(const CycleCache& other) {
+            std::atomic_store(&cycles, std::atomic_load(&other.cycles));
+            return *this;
+        }
+    };
+
+    mutable PropertyCache props;
+    mutable CycleCache cycleCache;
+
+    void invalidateCaches() {
+        props.bits.store(0, std::memory_order_relaxed);
+        std::atomic_store(&cycleCache.cycles, std::shared_ptr<const PermutationCycles<T>>());
+    }
+    void storeProperties(const Properties& p) const {
+        props.bits.store((unsigned char)(1 | p.function << 1 | p.injective << 2 | p.surjective << 3),
+            std::memory_order_relaxed);
+    }
+    unsigned char properties() const;
+    const Derived& derived() const { return static_cast<const Derived&>(*this); }
+
 public:
-    Functions();
-    void addMapping(const T& input, const U& output);
-    void display() const;
+    typedef T input_type;
+    typedef U output_type;
 
     bool isInjective() const;
     bool isSurjective() const;
     bool isBijective() const;
     bool isFunction() const;
-
-    U apply(const T& input) const;
-    Functions<U, T> inverse() const;
-
-    template <typename V>
-    Functions<T, V> compose(const Functions<U, V>& other) const;
-
     void displayProperties() const;
+
+    // Permutation view, only for bijections of a set onto itself (T == U).
+    // The cycle decomposition is built on first use and cached until mutation.
+    const PermutationCycles<T>& cycles() const;
+    unsigned long long order() const { return cycles().order; }
+    int sign() const { return cycles().sign; }
+    std::vector<T> fixedPoints() const;
+    void displayCycles() const;
     std::vector<T> getDomain() const { return domain; }
     std::vector<U> getCodomain() const { return codomain; }
 };
 
-// Template implementations
-template <typename T, typename U>
-Functions<T, U>::Functions() {}
+template <typename Derived, typename T, typename U>
+unsigned char FunctionsBase<Derived, T, U>::properties() const {
+    unsigned char bits = props.bits.load(std::memory_order_relaxed);
+    if (!(bits & 1)) {
+        storeProperties(derived().computeProperties());
+        bits = props.bits.load(std::memory_order_relaxed);
+    }
+    return bits;
+}
 
-template <typename T, typename U>
-void Functions<T, U>::addMapping(const T& input, const U& output) {
-    mapping[input] = output;
+template <typename Derived, typename T, typename U>
+bool FunctionsBase<Derived, T, U>::isFunction() const {
+    return (properties() >> 1) & 1;
+}
 
-    bool inDomain = false;
-    for (const T& d : domain) {
-        if (d == input) {
-            inDomain = true;
-            break;
-        }
+template <typename Derived, typename T, typename U>
+bool FunctionsBase<Derived, T, U>::isInjective() const {
+    return (properties() >> 2) & 1;
+}
+
+template <typename Derived, typename T, typename U>
+bool FunctionsBase<Derived, T, U>::isSurjective() const {
+    return (properties() >> 3) & 1;
+}
+
+template <typename Derived, typename T, typename U>
+bool FunctionsBase<Derived, T, U>::isBijective() const {
+    return isInjective() && isSurjective();
+}
+
+template <typename Derived, typename T, typename U>
+void FunctionsBase<Derived, T, U>::displayProperties() const {
+    std::cout << "\n=== Function Properties ===\n";
+    std::cout << "Is Valid Function: " << (isFunction() ? "YES" : "NO") << "\n";
+    std::cout << "Injective (One-to-One): " << (isInjective() ? "YES" : "NO") << "\n";
+    std::cout << "Surjective (Onto): " << (isSurjective() ? "YES" : "NO") << "\n";
+    std::cout << "Bijective: " << (isBijective() ? "YES" : "NO") << "\n";
+    std::cout << "Domain size: " << domain.size() << "\n";
+    std::cout << "Codomain size: " << codomain.size() << "\n";
+}
+
+template <typename Derived, typename T, typename U>
+const PermutationCycles<T>& FunctionsBase<Derived, T, U>::cycles() const {
+    static_assert(std::is_same<T, U>::value, "Permutations need the same domain and codomain type");
+    std::shared_ptr<const PermutationCycles<T>> cached = std::atomic_load(&cycleCache.cycles);
+    if (!cached) {
+        // If another reader published first, the exchange loads its result
+        std::shared_ptr<const PermutationCycles<T>> built = derived().buildCycles();
+        if (std::atomic_compare_exchange_strong(&cycleCache.cycles, &cached, built)) cached = built;
+    }
+    return *cached;
+}
+
+template <typename Derived, typename T, typename U>
+std::vector<T> FunctionsBase<Derived, T, U>::fixedPoints() const {
+    const PermutationCycles<T>& perm = cycles();
+    std::vector<T> points;
+    for (size_t i = 0; i < perm.cycleCount(); i++) {
+        if (perm.cycleStart[i + 1] - perm.cycleStart[i] == 1) points.push_back(perm.element(perm.cycleStart[i]));
     }
-    if (!inDomain) domain.push_back(input);
+    return points;
+}
 
-    bool inCodomain = false;
-    for (const U& c : codomain) {
-        if (c == output) {
-            inCodomain = true;
-            break;
+template <typename Derived, typename T, typename U>
+void FunctionsBase<Derived, T, U>::displayCycles() const {
+    const PermutationCycles<T>& perm = cycles();
+    std::cout << "Cycle decomposition: ";
+    for (size_t i = 0; i < perm.cycleCount(); i++) {
+        std::cout << "(";
+        for (size_t j = perm.cycleStart[i]; j < perm.cycleStart[i + 1]; j++) {
+            if (j > perm.cycleStart[i]) std::cout << " ";
+            std::cout << perm.element(j);
         }
+        std::cout << ")";
     }
-    if (!inCodomain) codomain.push_back(output);
+    std::cout << "\n";
+    std::cout << "Order: " << perm.order << "  Sign: " << (perm.sign > 0 ? "+1" : "-1") << "\n";
 }
 
-template <typename T, typename U>
-void Functions<T, U>::display() const {
+// Map backend, for any key type. Results of inverse, compose and power use the
+// backend of the function they are called on, whatever backend other uses.
+template <typename T, typename U, bool Dense = UseDenseMapping<T, U>::value>
+class Functions : public FunctionsBase<Functions<T, U, Dense>, T, U> {
+private:
+    template <typename, typename, bool> friend class Functions;
+    friend class FunctionsBase<Functions, T, U>;
+    typedef FunctionsBase<Functions, T, U> Base;
+    using Base::domain;
+    using Base::codomain;
+
+    std::map<T, U> mapping;
+    ValueSet<U> codomainSet;
+
+    typename Base::Properties computeProperties() const;
+    std::shared_ptr<const PermutationCycles<T>> buildCycles() const;
+
+public:
+    static const bool dense_backend = false;
+
+    Functions();
+    void reserve(size_t n);
+    void addMapping(const T& input, const U& output);
+    // Same result as calling addMapping for each pair in order
+    void addMappings(const std::vector<std::pair<T, U>>& pairs);
+    void display() const;
+
+    U apply(const T& input) const;
+    std::optional<U> tryApply(const T& input) const;
+    Functions<U, T, false> inverse() const;
+
+    template <typename V, bool OtherDense>
+    Functions<T, V, false> compose(const Functions<U, V, OtherDense>& other) const;
+    // Deferred compose: chain further with .compose(), then evaluate() once.
+    // Both functions are held by reference, so temporaries are rejected.
+    template <typename V, bool OtherDense>
+    LazyComposition<Functions, Functions<U, V, OtherDense>> composeLazy(const Functions<U, V, OtherDense>& other) const&;
+    template <typename V, bool OtherDense>
+    void composeLazy(const Functions<U, V, OtherDense>&& other) const& = delete;
+    template <typename Other>
+    void composeLazy(Other&& other) const&& = delete;
+    template <typename Fn>
+    void forEachMapping(Fn fn) const;
+
+    Functions power(long long k) const;
+};
+
+// Template implementations (std::map backend)
+template <typename T, typename U, bool Dense>
+Functions<T, U, Dense>::Functions() {}
+
+template <typename T, typename U, bool Dense>
+void Functions<T, U, Dense>::reserve(size_t n) {
+    domain.reserve(n);
+    codomain.reserve(n);
+    reserveValueSet<U>(codomainSet, n);
+}
+
+template <typename T, typename U, bool Dense>
+void Functions<T, U, Dense>::addMapping(const T& input, const U& output) {
+    this->invalidateCaches();
+
+    auto inserted = mapping.insert(std::make_pair(input, output));
+    if (inserted.second) domain.push_back(input);
+    else inserted.first->second = output;
+
+    if (codomainSet.insert(output).second) codomain.push_back(output);
+}
+
+template <typename T, typename U, bool Dense>
+void Functions<T, U, Dense>::addMappings(const std::vector<std::pair<T, U>>& pairs) {
+    if (!mapping.empty()) {
+        reserve(domain.size() + pairs.size());
+        for (const auto& p : pairs) addMapping(p.first, p.second);
+        return;
+    }
+
+    this->invalidateCaches();
+    reserve(pairs.size());
+    for (const auto& p : pairs) {
+        if (codomainSet.insert(p.second).second) codomain.push_back(p.second);
+    }
+
+    // Sort-unique bulk build: the last pair for a key wins, the domain keeps
+    // first-occurrence order, and the map is filled in key order with end hints
+    std::vector<size_t> order(pairs.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&pairs](size_t a, size_t b) {
+        return pairs[a].first < pairs[b].first;
+    });
+
+    std::vector<size_t> firstSeen;
+    firstSeen.reserve(pairs.size());
+    for (size_t i = 0; i < order.size();) {
+        size_t j = i;
+        while (j + 1 < order.size() && !(pairs[order[i]].first < pairs[order[j + 1]].first)) j++;
+        mapping.emplace_hint(mapping.end(), pairs[order[j]].first, pairs[order[j]].second);
+        firstSeen.push_back(order[i]);
+        i = j + 1;
+    }
+
+    std::sort(firstSeen.begin(), firstSeen.end());
+    for (size_t i : firstSeen) domain.push_back(pairs[i].first);
+}
+
+template <typename T, typename U, bool Dense>
+void Functions<T, U, Dense>::display() const {
     std::cout << "Function mappings:\n";
     for (const auto& pair : mapping) {
         std::cout << "  " << pair.first << " -> " << pair.second << "\n";
     }
 }
 
-template <typename T, typename U>
-bool Functions<T, U>::isFunction() const {
-    for (const T& d : domain) {
-        int count = 0;
+// Every image lies in the codomain, so counting distinct images answers both
+// injectivity and surjectivity
+template <typename T, typename U, bool Dense>
+typename Functions<T, U, Dense>::Base::Properties Functions<T, U, Dense>::computeProperties() const {
+    ValueSet<U> images;
+    reserveValueSet<U>(images, mapping.size());
+    for (const auto& pair : mapping) images.insert(pair.second);
+
+    typename Base::Properties p;
+    p.function = domain.size() == mapping.size();
+    p.injective = images.size() == mapping.size();
+    p.surjective = images.size() == codomain.size();
+    return p;
+}
+
+template <typename T, typename U, bool Dense>
+U Functions<T, U, Dense>::apply(const T& input) const {
+    auto it = mapping.find(input);
+    if (it != mapping.end()) {
+        return it->second;
+    }
+    throw std::runtime_error("Input not in domain");
+}
+
+template <typename T, typename U, bool Dense>
+std::optional<U> Functions<T, U, Dense>::tryApply(const T& input) const {
+    auto it = mapping.find(input);
+    if (it == mapping.end()) return std::nullopt;
+    return it->second;
+}
+
+template <typename T, typename U, bool Dense>
+template <typename Fn>
+void Functions<T, U, Dense>::forEachMapping(Fn fn) const {
+    for (const auto& pair : mapping) fn(pair.first, pair.second);
+}
+
+template <typename T, typename U, bool Dense>
+Functions<U, T, false> Functions<T, U, Dense>::inverse() const {
+    Functions<U, T, false> inv;
+    if (!this->isBijective()) {
+        std::cout << "Warning: Function is not bijective, inverse may not be well-defined\n";
+    }
+
+    std::vector<std::pair<U, T>> pairs;
+    pairs.reserve(mapping.size());
+    for (const auto& pair : mapping) {
+        pairs.push_back(std::make_pair(pair.second, pair.first));
+    }
+    inv.addMappings(pairs);
+    return inv;
+}
+
+template <typename T, typename U, bool Dense>
+template <typename V, bool OtherDense>
+Functions<T, V, false> Functions<T, U, Dense>::compose(const Functions<U, V, OtherDense>& other) const {
+    Functions<T, V, false> result;
+    std::vector<std::pair<T, V>> pairs;
+    pairs.reserve(mapping.size());
+
+    for (const auto& pair : mapping) {
+        // Skip if intermediate value not in other's domain
+        std::optional<V> output = other.tryApply(pair.second);
+        if (output) pairs.push_back(std::make_pair(pair.first, *output));
+    }
+
+    result.addMappings(pairs);
+    return result;
+}
+
+template <typename T, typename U, bool Dense>
+template <typename V, bool OtherDense>
+LazyComposition<Functions<T, U, Dense>, Functions<U, V, OtherDense>>
+Functions<T, U, Dense>::composeLazy(const Functions<U, V, OtherDense>& other) const& {
+    return LazyComposition<Functions, Functions<U, V, OtherDense>>(*this, other);
+}
+
+template <typename T, typename U, bool Dense>
+std::shared_ptr<const PermutationCycles<T>> Functions<T, U, Dense>::buildCycles() const {
+    // Slots follow the map's key order. An image's slot comes from a key -> slot
+    // hash table, O(n) expected overall; keys without std::hash fall back to a
+    // binary search over the sorted keys, O(n log n).
+    std::vector<T> keys;
+    keys.reserve(mapping.size());
+    for (const auto& pair : mapping) keys.push_back(pair.first);
+
+    std::vector<size_t> next;
+    next.reserve(keys.size());
+    if constexpr (IsHashable<T>::value) {
+        std::unordered_map<T, size_t> slotOf;
+        slotOf.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); i++) slotOf.emplace(keys[i], i);
+        for (const auto& pair : mapping) {
+            auto it = slotOf.find(pair.second);
+            next.push_back(it != slotOf.end() ? it->second : keys.size());
+        }
+    }
+    else {
         for (const auto& pair : mapping) {
-            if (pair.first == d) count++;
+            auto it = std::lower_bound(keys.begin(), keys.end(), pair.second);
+            next.push_back(it != keys.end() && !(pair.second < *it) ? size_t(it - keys.begin()) : keys.size());
         }
-        if (count != 1) return false;
     }
-    return true;
+    return decomposeCycles(std::move(keys), next);
 }
 
-template <typename T, typename U>
-bool Functions<T, U>::isInjective() const {
-    std::vector<U> images;
-    for (const auto& pair : mapping) {
-        for (const U& img : images) {
-            if (img == pair.second) return false;
+// Moves every element k places along its cycle. The keys are already sorted,
+// so the map is appended in order with end hints: O(n) on top of cycles()
+template <typename T, typename U, bool Dense>
+Functions<T, U, Dense> Functions<T, U, Dense>::power(long long k) const {
+    const PermutationCycles<T>& perm = this->cycles();
+    std::vector<size_t> target(perm.keys.size());
+
+    for (size_t i = 0; i < perm.cycleCount(); i++) {
+        size_t begin = perm.cycleStart[i];
+        long long length = (long long)(perm.cycleStart[i + 1] - begin);
+        long long shift = ((k % length) + length) % length;
+        for (long long j = 0; j < length; j++) {
+            target[perm.cycleSlots[begin + j]] = perm.cycleSlots[begin + (j + shift) % length];
         }
-        images.push_back(pair.second);
     }
-    return true;
+
+    // Same lists addMappings would build: the domain in key order and, since
+    // a permutation's images are distinct, the codomain in that order too
+    Functions result;
+    result.reserve(target.size());
+    for (size_t s = 0; s < target.size(); s++) {
+        const T& image = perm.keys[target[s]];
+        result.mapping.emplace_hint(result.mapping.end(), perm.keys[s], image);
+        result.codomain.push_back(image);
+        result.codomainSet.insert(image);
+    }
+    result.domain = perm.keys;
+    return result;
 }
 
+// Dense backend for small integral ids: image[x] holds f(x) wherever bit x of
+// definedBits is set. apply is an array load, compose a gather, inverse a
+// scatter, and the property checks a single bitmap pass.
 template <typename T, typename U>
-bool Functions<T, U>::isSurjective() const {
-    for (const U& c : codomain) {
-        bool found = false;
-        for (const auto& pair : mapping) {
-            if (pair.second == c) {
-                found = true;
-                break;
-            }
-        }
-        if (!found) return false;
+class Functions<T, U, true> : public FunctionsBase<Functions<T, U, true>, T, U> {
+    static_assert(IsDenseId<T>::value && IsDenseId<U>::value, "The dense backend needs unsigned integral ids");
+
+private:
+    template <typename, typename, bool> friend class Functions;
+    friend class FunctionsBase<Functions, T, U>;
+    typedef FunctionsBase<Functions, T, U> Base;
+    using Base::domain;
+    using Base::codomain;
+
+    std::vector<U> image;
+    std::vector<std::uint64_t> definedBits;
+    std::vector<std::uint64_t> codomainBits;
+
+    static bool testBit(const std::vector<std::uint64_t>& bits, size_t i) {
+        return i / 64 < bits.size() && ((bits[i / 64] >> (i % 64)) & 1);
     }
-    return true;
+    static void setBit(std::vector<std::uint64_t>& bits, size_t i) {
+        if (i / 64 >= bits.size()) bits.resize(i / 64 + 1, 0);
+        bits[i / 64] |= std::uint64_t(1) << (i % 64);
+    }
+    bool isDefined(size_t x) const { return testBit(definedBits, x); }
+
+    typename Base::Properties computeProperties() const;
+    std::shared_ptr<const PermutationCycles<T>> buildCycles() const;
+
+public:
+    static const bool dense_backend = true;
+
+    Functions();
+    void reserve(size_t n);
+    void addMapping(const T& input, const U& output);
+    void addMappings(const std::vector<std::pair<T, U>>& pairs);
+    void display() const;
+
+    U apply(const T& input) const;
+    std::optional<U> tryApply(const T& input) const;
+    Functions<U, T, true> inverse() const;
+
+    // The result stays dense when V is a dense id type
+    template <typename V, bool OtherDense>
+    Functions<T, V, IsDenseId<V>::value> compose(const Functions<U, V, OtherDense>& other) const;
+    // Deferred compose: chain further with .compose(), then evaluate() once.
+    // Both functions are held by reference, so temporaries are rejected.
+    template <typename V, bool OtherDense>
+    LazyComposition<Functions, Functions<U, V, OtherDense>> composeLazy(const Functions<U, V, OtherDense>& other) const&;
+    template <typename V, bool OtherDense>
+    void composeLazy(const Functions<U, V, OtherDense>&& other) const& = delete;
+    template <typename Other>
+    void composeLazy(Other&& other) const&& = delete;
+    template <typename Fn>
+    void forEachMapping(Fn fn) const;
+
+    Functions power(long long k) const;
+};
+
+// Template implementations (dense backend)
+template <typename T, typename U>
+Functions<T, U, true>::Functions() {}
+
+template <typename T, typename U>
+void Functions<T, U, true>::reserve(size_t n) {
+    image.reserve(n);
+    domain.reserve(n);
+    codomain.reserve(n);
 }
 
 template <typename T, typename U>
-bool Functions<T, U>::isBijective() const {
-    return isInjective() && isSurjective();
+void Functions<T, U, true>::addMapping(const T& input, const U& output) {
+    this->invalidateCaches();
+
+    size_t x = (size_t)input;
+    if (x >= image.size()) image.resize(x + 1, U());
+    if (!isDefined(x)) {
+        setBit(definedBits, x);
+        domain.push_back(input);
+    }
+    image[x] = output;
+
+    size_t y = (size_t)output;
+    if (!testBit(codomainBits, y)) {
+        setBit(codomainBits, y);
+        codomain.push_back(output);
+    }
 }
 
 template <typename T, typename U>
-U Functions<T, U>::apply(const T& input) const {
-    if (mapping.count(input)) {
-        return mapping.at(input);
+void Functions<T, U, true>::addMappings(const std::vector<std::pair<T, U>>& pairs) {
+    size_t maxInput = image.size();
+    for (const auto& p : pairs) maxInput = std::max(maxInput, (size_t)p.first + 1);
+    image.reserve(maxInput);
+    definedBits.reserve(maxInput / 64 + 1);
+    reserve(domain.size() + pairs.size());
+    for (const auto& p : pairs) addMapping(p.first, p.second);
+}
+
+template <typename T, typename U>
+void Functions<T, U, true>::display() const {
+    std::cout << "Function mappings:\n";
+    for (size_t x = 0; x < image.size(); x++) {
+        if (isDefined(x)) std::cout << "  " << T(x) << " -> " << image[x] << "\n";
+    }
+}
+
+template <typename T, typename U>
+typename Functions<T, U, true>::Base::Properties Functions<T, U, true>::computeProperties() const {
+    std::vector<std::uint64_t> seen(codomainBits.size(), 0);
+    size_t distinct = 0;
+    for (size_t x = 0; x < image.size(); x++) {
+        if (!isDefined(x)) continue;
+        U y = image[x];
+        std::uint64_t bit = std::uint64_t(1) << (y % 64);
+        if (!(seen[y / 64] & bit)) {
+            seen[y / 64] |= bit;
+            distinct++;
+        }
+    }
+
+    typename Base::Properties p;
+    p.function = true;  // one slot per input, so never multi-valued
+    p.injective = distinct == domain.size();
+    p.surjective = distinct == codomain.size();
+    return p;
+}
+
+template <typename T, typename U>
+U Functions<T, U, true>::apply(const T& input) const {
+    if (isDefined((size_t)input)) {
+        return image[(size_t)input];
     }
     throw std::runtime_error("Input not in domain");
 }
 
 template <typename T, typename U>
-Functions<U, T> Functions<T, U>::inverse() const {
-    Functions<U, T> inv;
-    if (!isBijective()) {
-        std::cout << "Warning: Function is not bijective, inverse may not be well-defined\n";
+std::optional<U> Functions<T, U, true>::tryApply(const T& input) const {
+    if (isDefined((size_t)input)) {
+        return image[(size_t)input];
     }
+    return std::nullopt;
+}
 
-    for (const auto& pair : mapping) {
-        inv.addMapping(pair.second, pair.first);
+template <typename T, typename U>
+template <typename Fn>
+void Functions<T, U, true>::forEachMapping(Fn fn) const {
+    for (size_t x = 0; x < image.size(); x++) {
+        if (isDefined(x)) fn(T(x), image[x]);
+    }
+}
+
+// Scatter image[x] -> x. A slot that is already filled is a collision, which
+// settles injectivity without a separate pass; later inputs win, as with the map.
+template <typename T, typename U>
+Functions<U, T, true> Functions<T, U, true>::inverse() const {
+    Functions<U, T, true> inv;
+    inv.image.assign(codomainBits.size() * 64, T());
+    inv.definedBits.assign(codomainBits.size(), 0);
+    inv.domain.reserve(domain.size());
+
+    bool collision = false;
+    for (size_t x = 0; x < image.size(); x++) {
+        if (!isDefined(x)) continue;
+        size_t y = (size_t)image[x];
+        if (!inv.isDefined(y)) {
+            setBit(inv.definedBits, y);
+            inv.domain.push_back(image[x]);
+        }
+        else collision = true;
+        inv.image[y] = T(x);
+    }
+
+    while (!inv.image.empty() && !inv.isDefined(inv.image.size() - 1)) inv.image.pop_back();
+    inv.codomain.reserve(domain.size());
+    inv.codomainBits.assign(image.size() / 64 + 1, 0);
+    for (size_t x = 0; x < image.size(); x++) {
+        if (!isDefined(x)) continue;
+        inv.codomain.push_back(T(x));
+        setBit(inv.codomainBits, x);
+    }
+
+    this->storeProperties({ true, !collision, inv.domain.size() == codomain.size() });
+    if (!this->isBijective()) {
+        std::cout << "Warning: Function is not bijective, inverse may not be well-defined\n";
     }
     return inv;
 }
 
 template <typename T, typename U>
-template <typename V>
-Functions<T, V> Functions<T, U>::compose(const Functions<U, V>& other) const {
-    Functions<T, V> result;
+template <typename V, bool OtherDense>
+Functions<T, V, IsDenseId<V>::value> Functions<T, U, true>::compose(const Functions<U, V, OtherDense>& other) const {
+    Functions<T, V, IsDenseId<V>::value> result;
 
-    for (const auto& pair : mapping) {
-        try {
-            V output = other.apply(pair.second);
-            result.addMapping(pair.first, output);
+    if constexpr (OtherDense && IsDenseId<V>::value && sizeof(V) < sizeof(std::uint64_t)) {
+        size_t n = image.size();
+        size_t tableSize = other.image.size();
+        if (n == 0 || tableSize == 0) return result;
+
+        // other flattened to one word per slot: its image in the low bits and
+        // whether the slot is defined in the top bit
+        typedef typename std::conditional<(sizeof(V) < 4), std::uint32_t, std::uint64_t>::type Entry;
+        const std::uint64_t* tableBits = other.definedBits.data();
+        std::vector<Entry> lookup(tableSize);
+        for (size_t y = 0; y < tableSize; y++) {
+            Entry defined = Entry((tableBits[y / 64] >> (y % 64)) & 1);
+            lookup[y] = Entry(other.image[y]) | (defined << (sizeof(Entry) * 8 - 1));
         }
-        catch (...) {
+
+        // Pass 1: branch-free gather of every image plus its keep flag
+        result.image.assign(n, V());
+        std::vector<unsigned char> kept(n);
+        denseGather(image.data(), lookup.data(), tableSize, result.image.data(), kept.data(), n);
+
+        // Pass 2: pack the flags into the bitmap, drop inputs undefined here,
+        // then list domain and codomain in input order
+        result.definedBits.assign(definedBits.size(), 0);
+        for (size_t x = 0; x < n; x++) result.definedBits[x / 64] |= std::uint64_t(kept[x]) << (x % 64);
+        for (size_t w = 0; w < definedBits.size(); w++) result.definedBits[w] &= definedBits[w];
+
+        // Every image lies in other's codomain, so its bitmap bounds ours. The
+        // lists are written branch-free too: each slot is stored, then kept by
+        // advancing the count only for defined inputs and first-seen images.
+        result.codomainBits.assign(other.codomainBits.size(), 0);
+        result.domain.resize(domain.size() + 1);
+        result.codomain.resize(domain.size() + 1);
+        T* dom = result.domain.data();
+        V* cod = result.codomain.data();
+        std::uint64_t* seen = result.codomainBits.data();
+        const std::uint64_t* bits = result.definedBits.data();
+        size_t domainCount = 0, codomainCount = 0;
+        for (size_t x = 0; x < n; x++) {
+            size_t defined = (bits[x / 64] >> (x % 64)) & 1;
+            size_t z = (size_t)result.image[x];
+            std::uint64_t bit = std::uint64_t(defined) << (z % 64);
+            dom[domainCount] = T(x);
+            domainCount += defined;
+            cod[codomainCount] = V(z);
+            codomainCount += (seen[z / 64] & bit) == 0 && defined;
+            seen[z / 64] |= bit;
+        }
+        result.domain.resize(domainCount);
+        result.codomain.resize(codomainCount);
+    }
+    else {
+        std::vector<std::pair<T, V>> pairs;
+        pairs.reserve(domain.size());
+        for (size_t x = 0; x < image.size(); x++) {
+            if (!isDefined(x)) continue;
             // Skip if intermediate value not in other's domain
+            std::optional<V> output = other.tryApply(image[x]);
+            if (output) pairs.push_back(std::make_pair(T(x), *output));
         }
+        result.addMappings(pairs);
     }
 
     return result;
 }
 
 template <typename T, typename U>
-void Functions<T, U>::displayProperties() const {
-    std::cout << "\n=== Function Properties ===\n";
-    std::cout << "Is Valid Function: " << (isFunction() ? "YES" : "NO") << "\n";
-    std::cout << "Injective (One-to-One): " << (isInjective() ? "YES" : "NO") << "\n";
-    std::cout << "Surjective (Onto): " << (isSurjective() ? "YES" : "NO") << "\n";
-    std::cout << "Bijective: " << (isBijective() ? "YES" : "NO") << "\n";
-    std::cout << "Domain size: " << domain.size() << "\n";
-    std::cout << "Codomain size: " << codomain.size() << "\n";
+template <typename V, bool OtherDense>
+LazyComposition<Functions<T, U, true>, Functions<U, V, OtherDense>>
+Functions<T, U, true>::composeLazy(const Functions<U, V, OtherDense>& other) const& {
+    return LazyComposition<Functions, Functions<U, V, OtherDense>>(*this, other);
 }
 
+template <typename T, typename U>
+std::shared_ptr<const PermutationCycles<T>> Functions<T, U, true>::buildCycles() const {
+    std::vector<T> keys;
+    std::vector<size_t> slotOf(image.size(), domain.size());
+    keys.reserve(domain.size());
+    for (size_t x = 0; x < image.size(); x++) {
+        if (!isDefined(x)) continue;
+        slotOf[x] = keys.size();
+        keys.push_back(T(x));
+    }
+
+    std::vector<size_t> next;
+    next.reserve(keys.size());
+    for (const T& x : keys) {
+        size_t y = (size_t)image[(size_t)x];
+        next.push_back(y < slotOf.size() ? slotOf[y] : keys.size());
+    }
+    return decomposeCycles(std::move(keys), next);
+}
+
+// Writes every element's image k places along its cycle straight into the
+// array, O(n) for any k
+template <typename T, typename U>
+Functions<T, U, true> Functions<T, U, true>::power(long long k) const {
+    const PermutationCycles<T>& perm = this->cycles();
+    Functions result;
+    result.image.assign(image.size(), U());
+    result.definedBits = definedBits;
+
+    for (size_t i = 0; i < perm.cycleCount(); i++) {
+        size_t begin = perm.cycleStart[i];
+        long long length = (long long)(perm.cycleStart[i + 1] - begin);
+        long long shift = ((k % length) + length) % length;
+        for (long long j = 0; j < length; j++) {
+            result.image[(size_t)perm.element(begin + j)] = perm.element(begin + (j + shift) % length);
+        }
+    }
+
+    result.domain = perm.keys;
+    result.codomain.reserve(perm.keys.size());
+    result.codomainBits.assign(codomainBits.size(), 0);
+    for (const T& x : perm.keys) {
+        U y = result.image[(size_t)x];
+        result.codomain.push_back(y);
+        setBit(result.codomainBits, (size_t)y);
+    }
+    return result;
+}
+
+template <typename F>
+struct IsLazyComposition : std::false_type {};
+
+template <typename Inner, typename Outer>
+struct IsLazyComposition<LazyComposition<Inner, Outer>> : std::true_type {};
+
+// Composition expression (this then outer) that owns no mappings. tryApply walks
+// the chain per element; evaluate() materialises the whole chain in one fused
+// pass over the first function's domain. Functions are held by reference, so
+// they must outlive the expression; the overloads that would bind a temporary
+// function are deleted.
+template <typename Inner, typename Outer>
+class LazyComposition {
+private:
+    typedef typename std::conditional<IsLazyComposition<Inner>::value,
+        Inner, const Inner&>::type InnerRef;
+
+    InnerRef inner;
+    const Outer& outer;
+
+public:
+    typedef typename Inner::input_type input_type;
+    typedef typename Outer::output_type output_type;
+    // evaluate() follows the first function's backend, as compose() does
+    static const bool dense_backend = Inner::dense_backend && IsDenseId<output_type>::value;
+
+    LazyComposition(const Inner& first, const Outer& second) : inner(first), outer(second) {}
+    LazyComposition(const Inner& first, const Outer&& second) = delete;
+
+    std::optional<output_type> tryApply(const input_type& input) const {
+        auto middle = inner.tryApply(input);
+        if (!middle) return std::nullopt;
+        return outer.tryApply(*middle);
+    }
+
+    output_type apply(const input_type& input) const {
+        std::optional<output_type> output = tryApply(input);
+        if (!output) throw std::runtime_error("Input not in domain");
+        return *output;
+    }
+
+    template <typename Next>
+    LazyComposition<LazyComposition, Next> compose(const Next& next) const {
+        return LazyComposition<LazyComposition, Next>(*this, next);
+    }
+    template <typename Next>
+    void compose(const Next&& next) const = delete;
+
+    template <typename Fn>
+    void forEachMapping(Fn fn) const {
+        const Outer& last = outer;
+        inner.forEachMapping([&fn, &last](const input_type& x, const typename Outer::input_type& y) {
+            std::optional<output_type> z = last.tryApply(y);
+            if (z) fn(x, *z);
+        });
+    }
+
+    Functions<input_type, output_type, dense_backend> evaluate() const {
+        std::vector<std::pair<input_type, output_type>> pairs;
+        forEachMapping([&pairs](const input_type& x, const output_type& z) {
+            pairs.push_back(std::make_pair(x, z));
+        });
+
+        Functions<input_type, output_type, dense_backend> result;
+        result.addMappings(pairs);
+        return result;
+    }
+};
+
 #endif
\ No newline at end of file
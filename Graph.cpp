@@ -0,0 +1,107 @@
+#include "Graph.h"
+#include <algorithm>
+
+using namespace std;
+
+int Graph::stronglyConnectedComponents(vector<int>& component) const {
+    component.assign(n, -1);
+    vector<int> index(n, -1), low(n, 0);
+    vector<char> onStack(n, 0);
+    vector<int> sccStack;
+    // Explicit call stack: vertex and the next out-edge to look at
+    vector<pair<int, size_t>> frames;
+    int counter = 0, count = 0;
+
+    for (int s = 0; s < n; s++) {
+        if (index[s] != -1) continue;
+        index[s] = low[s] = counter++;
+        sccStack.push_back(s);
+        onStack[s] = 1;
+        frames.push_back({ s, 0 });
+
+        while (!frames.empty()) {
+            int v = frames.back().first;
+            size_t& next = frames.back().second;
+
+            if (next < adj[v].size()) {
+                int w = adj[v][next++];
+                if (index[w] == -1) {
+                    index[w] = low[w] = counter++;
+                    sccStack.push_back(w);
+                    onStack[w] = 1;
+                    frames.push_back({ w, 0 });
+                }
+                else if (onStack[w]) {
+                    low[v] = min(low[v], index[w]);
+                }
+                continue;
+            }
+
+            // All edges of v done: close its component if v is the root
+            frames.pop_back();
+            if (low[v] == index[v]) {
+                int w;
+                do {
+                    w = sccStack.back();
+                    sccStack.pop_back();
+                    onStack[w] = 0;
+                    component[w] = count;
+                } while (w != v);
+                count++;
+            }
+            if (!frames.empty()) {
+                int parent = frames.back().first;
+                low[parent] = min(low[parent], low[v]);
+            }
+        }
+    }
+    return count;
+}
+
+vector<CyclicGroup> Graph::findCyclicGroups() const {
+    vector<int> component;
+    int count = stronglyConnectedComponents(component);
+
+    vector<vector<int>> members(count);
+    for (int v = 0; v < n; v++) members[component[v]].push_back(v);
+
+    vector<CyclicGroup> groups;
+    // BFS state shared by all components; each search only touches its own
+    // component, so the total stays O(V+E)
+    vector<int> parent(n, -1), seenBy(n, -1), queue;
+
+    for (int c = count - 1; c >= 0; c--) {
+        const vector<int>& group = members[c];
+        int start = group[0];
+        bool selfLoop = group.size() == 1 &&
+            find(adj[start].begin(), adj[start].end(), start) != adj[start].end();
+        if (group.size() == 1 && !selfLoop) continue;
+
+        CyclicGroup result;
+        result.members = group;
+
+        // Shortest path from start back to itself inside the component
+        queue.assign(1, start);
+        seenBy[start] = c;
+        int last = -1;
+        for (size_t head = 0; head < queue.size() && last == -1; head++) {
+            int u = queue[head];
+            for (int w : adj[u]) {
+                if (w == start) {
+                    last = u;
+                    break;
+                }
+                if (component[w] != c || seenBy[w] == c) continue;
+                seenBy[w] = c;
+                parent[w] = u;
+                queue.push_back(w);
+            }
+        }
+
+        for (int v = last; v != start; v = parent[v]) result.witness.push_back(v);
+        result.witness.push_back(start);
+        reverse(result.witness.begin(), result.witness.end());
+        groups.push_back(result);
+    }
+    return groups;
+}
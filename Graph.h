@@ -4,6 +4,13 @@
 #include <vector>
 #include <string>
 
+// A strongly connected component that contains a cycle, with one such cycle
+// as witness: witness[0] -> witness[1] -> ... -> witness.back() -> witness[0]
+struct CyclicGroup {
+    std::vector<int> members;
+    std::vector<int> witness;
+};
+
 class Graph {
 protected:
     int n;
@@ -16,6 +23,13 @@ public:
     virtual bool hasCycle() const = 0;
     virtual void addEdge(int u, int v) = 0;
     virtual int getNodeCount() const { return n; }
+
+    // Iterative Tarjan, O(V+E) with no recursion. component[v] receives the
+    // SCC id of v; ids are in reverse topological order of the condensation.
+    // Returns the number of components.
+    int stronglyConnectedComponents(std::vector<int>& component) const;
+    // Every component with more than one vertex or a self-loop, O(V+E) total
+    std::vector<CyclicGroup> findCyclicGroups() const;
 };
 
-#endif
\ No newline at end of file
+#endif
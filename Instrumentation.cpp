@@ -0,0 +1,126 @@
+#include "Instrumentation.h"
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+static const char* phaseNames[PhaseCount] = {
+    "Prerequisites", "Time conflicts", "Room conflicts", "Faculty conflicts", "Credit overload"
+};
+
+// Live thread blocks, plus totals folded in from threads that have exited
+struct StatRegistry {
+    mutex lock;
+    vector<StatBlock*> blocks;
+    EngineStats retired;
+};
+
+static StatRegistry& registry() {
+    static StatRegistry r;
+    return r;
+}
+
+static void accumulate(EngineStats& total, const StatBlock& block) {
+    auto get = [](const atomic<unsigned long long>& c) { return c.load(memory_order_relaxed); };
+    total.memoHits += get(block.counters[StatMemoHits]);
+    total.memoMisses += get(block.counters[StatMemoMisses]);
+    total.memoEntries += get(block.counters[StatMemoEntries]);
+    total.statesExpanded += get(block.counters[StatStatesExpanded]);
+    total.sequencesGenerated += get(block.counters[StatSequencesGenerated]);
+    total.maxRecursionDepth = max(total.maxRecursionDepth, get(block.counters[StatMaxDepth]));
+    total.checkRuns += get(block.counters[StatCheckRuns]);
+    for (int p = 0; p < PhaseCount; p++) {
+        total.phaseRuns[p] += get(block.phaseRuns[p]);
+        total.phaseScans[p] += get(block.phaseScans[p]);
+        total.phaseMs[p] += get(block.phaseNs[p]) / 1e6;
+    }
+}
+
+StatBlock::StatBlock() : depth(0) {
+    for (auto& c : counters) c.store(0, memory_order_relaxed);
+    for (int p = 0; p < PhaseCount; p++) {
+        phaseRuns[p].store(0, memory_order_relaxed);
+        phaseScans[p].store(0, memory_order_relaxed);
+        phaseNs[p].store(0, memory_order_relaxed);
+    }
+    StatRegistry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    r.blocks.push_back(this);
+}
+
+StatBlock::~StatBlock() {
+    StatRegistry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    accumulate(r.retired, *this);
+    r.blocks.erase(remove(r.blocks.begin(), r.blocks.end(), this), r.blocks.end());
+}
+
+double EngineStats::memoHitRate() const {
+    unsigned long long lookups = memoHits + memoMisses;
+    return lookups ? (double)memoHits / lookups : 0.0;
+}
+
+double EngineStats::scansPerCheck(StatPhase phase) const {
+    return phaseRuns[phase] ? (double)phaseScans[phase] / phaseRuns[phase] : 0.0;
+}
+
+bool Instrumentation::isEnabled() {
+#ifdef DISCRETE_ENABLE_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+EngineStats Instrumentation::stats() {
+    StatRegistry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    EngineStats total = r.retired;
+    for (const StatBlock* block : r.blocks) accumulate(total, *block);
+    return total;
+}
+
+// Counters written concurrently by their owners may keep an increment that
+// raced with the reset; fine for polling, not for exact accounting.
+void Instrumentation::reset() {
+    StatRegistry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    r.retired = EngineStats();
+    for (StatBlock* block : r.blocks) {
+        for (auto& c : block->counters) c.store(0, memory_order_relaxed);
+        for (int p = 0; p < PhaseCount; p++) {
+            block->phaseRuns[p].store(0, memory_order_relaxed);
+            block->phaseScans[p].store(0, memory_order_relaxed);
+            block->phaseNs[p].store(0, memory_order_relaxed);
+        }
+    }
+}
+
+void Instrumentation::displayStats() {
+    cout << "\n=== Engine Statistics ===\n";
+    if (!isEnabled()) {
+        cout << "(Instrumentation disabled - rebuild with DISCRETE_ENABLE_STATS)\n";
+        return;
+    }
+
+    EngineStats s = stats();
+    cout << "Memo hits / misses: " << s.memoHits << " / " << s.memoMisses
+        << " (hit rate " << fixed << setprecision(1) << s.memoHitRate() * 100 << "%)\n";
+    cout << "Memo entries: " << s.memoEntries << "\n";
+    cout << "States expanded: " << s.statesExpanded << "\n";
+    cout << "Sequences generated: " << s.sequencesGenerated << "\n";
+    cout << "Max recursion depth: " << s.maxRecursionDepth << "\n";
+    cout << "Consistency checks: " << s.checkRuns << "\n";
+    cout << "---------------------------------------\n";
+    cout << left << setw(20) << "Phase" << right << setw(8) << "Runs"
+        << setw(14) << "Scans/run" << setw(12) << "Total ms" << "\n";
+    for (int p = 0; p < PhaseCount; p++) {
+        cout << left << setw(20) << phaseNames[p] << right << setw(8) << s.phaseRuns[p]
+            << setw(14) << setprecision(1) << s.scansPerCheck(StatPhase(p))
+            << setw(12) << setprecision(3) << s.phaseMs[p] << "\n";
+    }
+    cout << "---------------------------------------\n";
+}
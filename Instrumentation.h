@@ -0,0 +1,123 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <atomic>
+#include <chrono>
+
+// Hot-path counters for the counting and checking engines. The hooks below are
+// only compiled in when DISCRETE_ENABLE_STATS is defined; otherwise every
+// STATS_* macro expands to nothing and stats() returns zeros.
+
+enum StatCounter {
+    StatMemoHits,
+    StatMemoMisses,
+    StatMemoEntries,        // memo size after the last countSequences() on the thread
+    StatStatesExpanded,
+    StatSequencesGenerated,
+    StatMaxDepth,           // deepest recursion seen
+    StatCheckRuns,
+    StatCounterCount
+};
+
+enum StatPhase {
+    PhasePrerequisites,
+    PhaseTimeConflicts,
+    PhaseRoomConflicts,
+    PhaseFacultyConflicts,
+    PhaseCreditOverload,
+    PhaseCount
+};
+
+struct EngineStats {
+    unsigned long long memoHits = 0;
+    unsigned long long memoMisses = 0;
+    unsigned long long memoEntries = 0;
+    unsigned long long statesExpanded = 0;
+    unsigned long long sequencesGenerated = 0;
+    unsigned long long maxRecursionDepth = 0;
+    unsigned long long checkRuns = 0;
+    unsigned long long phaseRuns[PhaseCount] = {};
+    unsigned long long phaseScans[PhaseCount] = {};  // records visited by the phase
+    double phaseMs[PhaseCount] = {};
+
+    double memoHitRate() const;
+    double scansPerCheck(StatPhase phase) const;
+};
+
+// One block per thread. Only the owning thread writes it (relaxed load+store,
+// no locked instructions); stats() reads every block and adds them up.
+struct StatBlock {
+    std::atomic<unsigned long long> counters[StatCounterCount];
+    std::atomic<unsigned long long> phaseRuns[PhaseCount];
+    std::atomic<unsigned long long> phaseScans[PhaseCount];
+    std::atomic<unsigned long long> phaseNs[PhaseCount];
+    unsigned long long depth;
+
+    StatBlock();
+    ~StatBlock();
+
+    static void bump(std::atomic<unsigned long long>& c, unsigned long long n) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    void add(StatCounter c, unsigned long long n) { bump(counters[c], n); }
+    void set(StatCounter c, unsigned long long v) { counters[c].store(v, std::memory_order_relaxed); }
+    void scan(StatPhase p, unsigned long long n) { bump(phaseScans[p], n); }
+};
+
+class Instrumentation {
+public:
+    static bool isEnabled();
+    // Totals over all live threads plus threads that have already exited
+    static EngineStats stats();
+    static void reset();
+    static void displayStats();
+
+    static StatBlock& local() {
+        thread_local StatBlock block;
+        return block;
+    }
+};
+
+// Tracks recursion depth for the enclosing call
+class StatDepthScope {
+    StatBlock& block;
+public:
+    StatDepthScope() : block(Instrumentation::local()) {
+        if (++block.depth > block.counters[StatMaxDepth].load(std::memory_order_relaxed))
+            block.set(StatMaxDepth, block.depth);
+    }
+    ~StatDepthScope() { block.depth--; }
+};
+
+// Times the enclosing scope and charges it to a check phase
+class StatPhaseTimer {
+    StatPhase phase;
+    std::chrono::steady_clock::time_point start;
+public:
+    explicit StatPhaseTimer(StatPhase p) : phase(p), start(std::chrono::steady_clock::now()) {}
+    ~StatPhaseTimer() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        StatBlock& block = Instrumentation::local();
+        StatBlock::bump(block.phaseRuns[phase], 1);
+        StatBlock::bump(block.phaseNs[phase], (unsigned long long)ns);
+    }
+};
+
+#ifdef DISCRETE_ENABLE_STATS
+#define STATS_COUNT(counter) Instrumentation::local().add(counter, 1)
+#define STATS_ADD(counter, n) Instrumentation::local().add(counter, (n))
+#define STATS_SET(counter, v) Instrumentation::local().set(counter, (v))
+#define STATS_SCAN(phase) Instrumentation::local().scan(phase, 1)
+#define STATS_DEPTH_SCOPE() StatDepthScope statsDepthScope
+#define STATS_PHASE_TIMER(phase) StatPhaseTimer statsPhaseTimer(phase)
+#else
+#define STATS_COUNT(counter) ((void)0)
+#define STATS_ADD(counter, n) ((void)0)
+#define STATS_SET(counter, v) ((void)0)
+#define STATS_SCAN(phase) ((void)0)
+#define STATS_DEPTH_SCOPE() ((void)0)
+#define STATS_PHASE_TIMER(phase) ((void)0)
+#endif
+
+#endif
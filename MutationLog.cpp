@@ -0,0 +1,331 @@
+#include "MutationLog.h"
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+using namespace std;
+
+static const char LOG_MAGIC[8] = { 'C', 'C', 'M', 'L', 'O', 'G', '0', '1' };
+static const size_t HEADER_SIZE = 16;
+
+static void putU32(vector<char>& out, unsigned int v) {
+    for (int i = 0; i < 4; i++) out.push_back(char((v >> (8 * i)) & 0xFF));
+}
+
+static void putU64(vector<char>& out, unsigned long long v) {
+    for (int i = 0; i < 8; i++) out.push_back(char((v >> (8 * i)) & 0xFF));
+}
+
+static void putString(vector<char>& out, const string& s) {
+    putU32(out, (unsigned int)s.size());
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+static unsigned int getU32(const char* p) {
+    unsigned int v = 0;
+    for (int i = 0; i < 4; i++) v |= (unsigned int)(unsigned char)p[i] << (8 * i);
+    return v;
+}
+
+static unsigned long long getU64(const char* p) {
+    unsigned long long v = 0;
+    for (int i = 0; i < 8; i++) v |= (unsigned long long)(unsigned char)p[i] << (8 * i);
+    return v;
+}
+
+// FNV-1a, enough to tell a torn write from a complete record
+static unsigned int checksum(const char* p, size_t len) {
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void encodeRecord(vector<char>& out, const LogRecord& record) {
+    size_t lenPos = out.size();
+    putU32(out, 0);
+    size_t start = out.size();
+
+    out.push_back(char(record.type));
+    putString(out, record.a);
+    putString(out, record.b);
+    putString(out, record.c);
+    putU32(out, (unsigned int)record.value);
+
+    unsigned int len = (unsigned int)(out.size() - start);
+    for (int i = 0; i < 4; i++) out[lenPos + i] = char((len >> (8 * i)) & 0xFF);
+    putU32(out, checksum(out.data() + start, len));
+}
+
+static bool decodeString(const char*& p, const char* end, string& s) {
+    if (end - p < 4) return false;
+    unsigned int len = getU32(p);
+    p += 4;
+    if ((size_t)(end - p) < len) return false;
+    s.assign(p, len);
+    p += len;
+    return true;
+}
+
+static bool decodeRecord(const char* p, const char* end, LogRecord& record) {
+    if (p == end) return false;
+    unsigned char type = (unsigned char)*p++;
+    if (type < LogRecord::Enroll || type > LogRecord::Course) return false;
+    record.type = LogRecord::Type(type);
+
+    if (!decodeString(p, end, record.a)) return false;
+    if (!decodeString(p, end, record.b)) return false;
+    if (!decodeString(p, end, record.c)) return false;
+    if (end - p != 4) return false;
+    record.value = (int)getU32(p);
+    return true;
+}
+
+static bool syncHandle(FILE* f) {
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+// Replaces filePath with tmpPath and makes the rename itself durable: on POSIX
+// by fsyncing the parent directory, on Windows with a write-through move
+static bool durableRename(const string& tmpPath, const string& filePath) {
+#ifdef _WIN32
+    return MoveFileExA(tmpPath.c_str(), filePath.c_str(),
+        MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (rename(tmpPath.c_str(), filePath.c_str()) != 0) return false;
+
+    string dir = filesystem::path(filePath).parent_path().string();
+    if (dir.empty()) dir = ".";
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+
+MutationLog::MutationLog()
+    : file(nullptr), pendingRecords(0), generation(0), unsynced(false), failed(false), stopping(false) {}
+
+MutationLog::~MutationLog() {
+    close();
+}
+
+bool MutationLog::open(const string& logPath, const LogOptions& opts, unsigned long long gen) {
+    close();
+    path = logPath;
+    options = opts;
+    generation = gen;
+
+    error_code ec;
+    auto size = filesystem::file_size(path, ec);
+    if (ec || size < HEADER_SIZE) {
+        if (!writeFile(path, gen, {})) return false;
+    }
+
+    file = fopen(path.c_str(), "ab");
+    if (!file) return false;
+    failed = false;
+    unsynced = false;
+    lastSync = chrono::steady_clock::now();
+
+    if (options.maxCommitDelayMs > 0 || options.syncPolicy == SyncPolicy::Interval) {
+        stopping = false;
+        flusher = thread(&MutationLog::flushLoop, this);
+    }
+    return true;
+}
+
+void MutationLog::close() {
+    if (!file) return;
+    if (flusher.joinable()) {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        flusher.join();
+    }
+
+    sync();
+    fclose(file);
+    file = nullptr;
+    buffer.clear();
+    pendingRecords = 0;
+}
+
+bool MutationLog::append(const LogRecord& record) {
+    lock_guard<mutex> guard(lock);
+    if (!file || failed) return false;
+    if (buffer.empty()) oldestPending = chrono::steady_clock::now();
+    encodeRecord(buffer, record);
+    pendingRecords++;
+
+    if (pendingRecords >= options.groupCommitRecords || buffer.size() >= options.groupCommitBytes) {
+        return commitLocked();
+    }
+    return true;
+}
+
+// A short write can leave a torn record, and replay stops there, so nothing
+// appended after it would ever be recovered: the log is failed for good
+bool MutationLog::writeBuffer() {
+    if (buffer.empty()) return true;
+    bool ok = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    ok = fflush(file) == 0 && ok;
+    buffer.clear();
+    pendingRecords = 0;
+    if (!ok) failed = true;
+    else unsynced = true;
+    return ok;
+}
+
+bool MutationLog::syncFile() {
+    if (!syncHandle(file)) {
+        failed = true;
+        return false;
+    }
+    unsynced = false;
+    lastSync = chrono::steady_clock::now();
+    return true;
+}
+
+// Writes the whole pending group with one write call and at most one fsync
+bool MutationLog::commitLocked() {
+    if (!file || failed) return false;
+    if (buffer.empty()) return true;
+    if (!writeBuffer()) return false;
+
+    if (options.syncPolicy == SyncPolicy::EveryCommit) {
+        return syncFile();
+    }
+    if (options.syncPolicy == SyncPolicy::Interval) {
+        auto elapsed = chrono::steady_clock::now() - lastSync;
+        if (elapsed >= chrono::milliseconds(options.syncIntervalMs)) return syncFile();
+    }
+    return true;
+}
+
+bool MutationLog::commit() {
+    lock_guard<mutex> guard(lock);
+    return commitLocked();
+}
+
+bool MutationLog::sync() {
+    lock_guard<mutex> guard(lock);
+    if (!file || failed) return false;
+    return writeBuffer() && syncFile();
+}
+
+// Bounds how long a record can sit in the buffer, and makes the Interval
+// policy sync the last group even when no further commit arrives
+void MutationLog::flushLoop() {
+    int tick = options.maxCommitDelayMs > 0 ? options.maxCommitDelayMs : options.syncIntervalMs;
+    if (options.syncPolicy == SyncPolicy::Interval) tick = min(tick, options.syncIntervalMs);
+    tick = max(tick, 1);
+
+    unique_lock<mutex> guard(lock);
+    while (!stopping) {
+        wake.wait_for(guard, chrono::milliseconds(tick));
+        if (stopping || failed) continue;
+
+        auto now = chrono::steady_clock::now();
+        if (!buffer.empty() && options.maxCommitDelayMs > 0 &&
+            now - oldestPending >= chrono::milliseconds(options.maxCommitDelayMs)) {
+            commitLocked();
+        }
+        if (unsynced && options.syncPolicy == SyncPolicy::Interval &&
+            now - lastSync >= chrono::milliseconds(options.syncIntervalMs)) {
+            syncFile();
+        }
+    }
+}
+
+bool MutationLog::reset(unsigned long long gen) {
+    LogOptions opts = options;
+    close();
+    return writeFile(path, gen, {}) && open(path, opts, gen);
+}
+
+bool MutationLog::replay(const string& filePath, unsigned long long& gen,
+    const function<void(const LogRecord&)>& apply, long long& validBytes) {
+    validBytes = 0;
+    ifstream in(filePath, ios::binary);
+    if (!in) return false;
+    vector<char> data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+
+    if (data.size() < HEADER_SIZE || memcmp(data.data(), LOG_MAGIC, sizeof(LOG_MAGIC)) != 0) {
+        return false;
+    }
+    gen = getU64(data.data() + sizeof(LOG_MAGIC));
+
+    const char* p = data.data() + HEADER_SIZE;
+    const char* end = data.data() + data.size();
+    LogRecord record;
+    while (end - p >= 4) {
+        unsigned int len = getU32(p);
+        if ((size_t)(end - p) < 8 + (size_t)len) break;
+        const char* payload = p + 4;
+        if (getU32(payload + len) != checksum(payload, len)) break;
+        if (!decodeRecord(payload, payload + len, record)) break;
+
+        apply(record);
+        p = payload + len + 4;
+    }
+
+    validBytes = p - data.data();
+    return true;
+}
+
+bool MutationLog::readGeneration(const string& filePath, unsigned long long& gen) {
+    ifstream in(filePath, ios::binary);
+    char header[HEADER_SIZE];
+    if (!in.read(header, HEADER_SIZE)) return false;
+    if (memcmp(header, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0) return false;
+    gen = getU64(header + sizeof(LOG_MAGIC));
+    return true;
+}
+
+bool MutationLog::truncate(const string& filePath, long long length) {
+    error_code ec;
+    filesystem::resize_file(filePath, (uintmax_t)length, ec);
+    return !ec;
+}
+
+// Writes to a temporary file and renames it into place, so readers only ever
+// see the old or the new contents. Returns true only once both the contents
+// and the rename are on stable storage.
+bool MutationLog::writeFile(const string& filePath, unsigned long long gen,
+    const vector<LogRecord>& records) {
+    vector<char> data(LOG_MAGIC, LOG_MAGIC + sizeof(LOG_MAGIC));
+    putU64(data, gen);
+    for (const LogRecord& r : records) encodeRecord(data, r);
+
+    string tmpPath = filePath + ".tmp";
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = fflush(f) == 0 && ok;
+    ok = syncHandle(f) && ok;
+    ok = fclose(f) == 0 && ok;
+    if (!ok) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return durableRename(tmpPath, filePath);
+}
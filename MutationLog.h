@@ -0,0 +1,107 @@
+#ifndef MUTATIONLOG_H
+#define MUTATIONLOG_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <chrono>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+// When buffered records are forced to stable storage after a group is written
+enum class SyncPolicy {
+    Never,        // write only, leave flushing to the OS
+    EveryCommit,  // fsync once per group commit
+    Interval      // fsync at most once every syncIntervalMs, and within
+                  // syncIntervalMs of the last write once traffic stops
+};
+
+struct LogOptions {
+    size_t groupCommitRecords = 64;
+    size_t groupCommitBytes = 64 * 1024;
+    // A background flusher commits any group whose oldest record has waited
+    // this long, so buffered records are never held indefinitely. 0 disables it.
+    int maxCommitDelayMs = 5;
+    SyncPolicy syncPolicy = SyncPolicy::EveryCommit;
+    int syncIntervalMs = 50;
+};
+
+struct LogRecord {
+    enum Type : unsigned char {
+        Enroll = 1,    // a = student, b = course, c = time slot
+        Assign = 2,    // a = faculty, b = course, c = room
+        Complete = 3,  // a = student, b = course
+        Prereq = 4,    // a = course,  b = prerequisite
+        Credit = 5,    // a = course,  value = credits
+        Course = 6     // a = course
+    };
+
+    Type type;
+    std::string a;
+    std::string b;
+    std::string c;
+    int value;
+};
+
+// Append-only binary log of checker mutations. Records are framed as
+// [length][payload][checksum] behind a small header carrying a generation
+// number, so a torn tail is detected on replay and a log that was already
+// folded into a snapshot is recognised after a crash during compaction.
+// A failed write or fsync marks the log as failed: every later append
+// returns false instead of silently dropping records.
+class MutationLog {
+private:
+    std::string path;
+    FILE* file;
+    LogOptions options;
+    std::vector<char> buffer;
+    size_t pendingRecords;
+    unsigned long long generation;
+    std::chrono::steady_clock::time_point lastSync;
+    std::chrono::steady_clock::time_point oldestPending;
+    bool unsynced;
+    std::atomic<bool> failed;
+
+    // Guards the buffer and file against the flusher thread
+    std::mutex lock;
+    std::condition_variable wake;
+    std::thread flusher;
+    bool stopping;
+
+    bool writeBuffer();
+    bool syncFile();
+    bool commitLocked();
+    void flushLoop();
+
+public:
+    MutationLog();
+    ~MutationLog();
+
+    bool open(const std::string& logPath, const LogOptions& opts, unsigned long long gen);
+    void close();
+    // False once closed or after a write failure
+    bool isOpen() const { return file != nullptr && !failed; }
+    unsigned long long getGeneration() const { return generation; }
+
+    // Each returns false if the record(s) could not be written
+    bool append(const LogRecord& record);
+    bool commit();
+    bool sync();
+
+    // Replaces the log with an empty one of the given generation
+    bool reset(unsigned long long gen);
+
+    // Returns false if the file is missing or has a bad header. Stops at the
+    // first torn or corrupt record and reports the length of the valid prefix.
+    static bool replay(const std::string& filePath, unsigned long long& gen,
+        const std::function<void(const LogRecord&)>& apply, long long& validBytes);
+    static bool readGeneration(const std::string& filePath, unsigned long long& gen);
+    static bool truncate(const std::string& filePath, long long length);
+    static bool writeFile(const std::string& filePath, unsigned long long gen,
+        const std::vector<LogRecord>& records);
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+PerfCounters::PerfCounters() {
+    for (int i = 0; i < EventCount; i++) {
+        fds[i] = -1;
+        values[i] = 0;
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    close();
+}
+
+const char* PerfCounters::eventName(Event e) {
+    static const char* names[EventCount] = {
+        "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "page_faults"
+    };
+    return names[e];
+}
+
+#ifdef __linux__
+
+static int openEvent(unsigned int type, unsigned long long config) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;  // user space only, allowed at perf_event_paranoid 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+bool PerfCounters::open() {
+    close();
+    const unsigned long long l1dMiss = PERF_COUNT_HW_CACHE_L1D |
+        (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+    fds[Cycles] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds[Instructions] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds[L1DMisses] = openEvent(PERF_TYPE_HW_CACHE, l1dMiss);
+    fds[LLCMisses] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    fds[BranchMisses] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    fds[PageFaults] = openEvent(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+
+    for (int i = 0; i < EventCount; i++) {
+        if (fds[i] >= 0) return true;
+    }
+    return false;
+}
+
+void PerfCounters::close() {
+    for (int i = 0; i < EventCount; i++) {
+        if (fds[i] >= 0) ::close(fds[i]);
+        fds[i] = -1;
+    }
+}
+
+void PerfCounters::start() {
+    for (int i = 0; i < EventCount; i++) {
+        values[i] = 0;
+        if (fds[i] < 0) continue;
+        ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void PerfCounters::stop() {
+    for (int i = 0; i < EventCount; i++) {
+        if (fds[i] >= 0) ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    for (int i = 0; i < EventCount; i++) {
+        if (fds[i] < 0) continue;
+        unsigned long long data[3] = { 0, 0, 0 };  // value, time enabled, time running
+        if (read(fds[i], data, sizeof(data)) != (ssize_t)sizeof(data)) continue;
+        values[i] = data[2] > 0 && data[2] < data[1]
+            ? (unsigned long long)((double)data[0] * data[1] / data[2])
+            : data[0];
+    }
+}
+
+#else
+
+bool PerfCounters::open() { return false; }
+void PerfCounters::close() {}
+void PerfCounters::start() {}
+void PerfCounters::stop() {}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+// Hardware/software event counters for the calling thread via Linux
+// perf_event_open. Each event is opened on its own, so a kernel or VM that
+// refuses some of them (or perf_event_paranoid settings) only loses those;
+// on other platforms nothing opens and every event reports unavailable.
+class PerfCounters {
+public:
+    enum Event {
+        Cycles,
+        Instructions,
+        L1DMisses,
+        LLCMisses,
+        BranchMisses,
+        PageFaults,
+        EventCount
+    };
+
+private:
+    int fds[EventCount];
+    unsigned long long values[EventCount];
+
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    // Returns true if at least one event could be opened
+    bool open();
+    void close();
+
+    void start();
+    void stop();
+
+    bool isAvailable(Event e) const { return fds[e] >= 0; }
+    // Count since the last start(), scaled up if the kernel multiplexed the event
+    unsigned long long value(Event e) const { return values[e]; }
+    static const char* eventName(Event e);
+};
+
+#endif
@@ -0,0 +1,314 @@
+#include "TimetableScheduler.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <set>
+#include <tuple>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+TimetableScheduler::TimetableScheduler() {}
+
+int TimetableScheduler::indexOf(const string& course) {
+    auto it = courseIdx.find(course);
+    if (it != courseIdx.end()) return it->second;
+
+    int idx = (int)courses.size();
+    courseIdx[course] = idx;
+    courses.push_back(course);
+    students.push_back(unordered_map<int, long long>());
+    hard.push_back(unordered_map<int, int>());
+    return idx;
+}
+
+void TimetableScheduler::addCourse(const string& course) {
+    indexOf(course);
+}
+
+void TimetableScheduler::addSlot(const string& slot) {
+    if (find(slots.begin(), slots.end(), slot) == slots.end()) slots.push_back(slot);
+}
+
+void TimetableScheduler::addAssignment(const Assignment& assignment) {
+    int c = indexOf(assignment.courseId);
+
+    for (auto* group : { &facultyCourses[assignment.facultyId], &roomCourses[assignment.roomId] }) {
+        if (find(group->begin(), group->end(), c) != group->end()) continue;
+        for (int other : *group) {
+            hard[c][other]++;
+            hard[other][c]++;
+        }
+        group->push_back(c);
+    }
+}
+
+void TimetableScheduler::addOverlap(const string& course1, const string& course2, long long sharedStudents) {
+    int a = indexOf(course1);
+    int b = indexOf(course2);
+    if (a == b || sharedStudents <= 0) return;
+    students[a][b] += sharedStudents;
+    students[b][a] += sharedStudents;
+}
+
+void TimetableScheduler::loadFrom(const ConsistencyChecker& checker) {
+    for (const Assignment& a : checker.getAssignments()) {
+        addAssignment(a);
+    }
+
+    map<string, vector<int>> byStudent;
+    for (const Enrollment& e : checker.getEnrollments()) {
+        vector<int>& list = byStudent[e.studentId];
+        int c = indexOf(e.courseId);
+        if (find(list.begin(), list.end(), c) == list.end()) list.push_back(c);
+    }
+
+    for (const auto& pair : byStudent) {
+        const vector<int>& list = pair.second;
+        for (size_t i = 0; i < list.size(); i++) {
+            for (size_t j = i + 1; j < list.size(); j++) {
+                students[list[i]][list[j]]++;
+                students[list[j]][list[i]]++;
+            }
+        }
+    }
+}
+
+void TimetableScheduler::buildGraph() {
+    int n = (int)courses.size();
+    edgeStart.assign(n + 1, 0);
+    edgeTo.clear();
+    edgeWeight.clear();
+
+    for (int u = 0; u < n; u++) {
+        map<int, long long> merged;
+        for (const auto& e : students[u]) merged[e.first] += e.second;
+        for (const auto& e : hard[u]) merged[e.first] += HARD_WEIGHT * e.second;
+        for (const auto& e : merged) {
+            edgeTo.push_back(e.first);
+            edgeWeight.push_back(e.second);
+        }
+        edgeStart[u + 1] = (int)edgeTo.size();
+    }
+}
+
+long long TimetableScheduler::costOf(const vector<int>& color) const {
+    long long cost = 0;
+    for (int u = 0; u < (int)courses.size(); u++) {
+        for (int e = edgeStart[u]; e < edgeStart[u + 1]; e++) {
+            if (edgeTo[e] > u && color[edgeTo[e]] == color[u]) cost += edgeWeight[e];
+        }
+    }
+    return cost;
+}
+
+// DSATUR: repeatedly colour the course whose neighbours already use the most
+// distinct slots, giving it the slot with the least conflict weight
+vector<int> TimetableScheduler::dsatur() const {
+    int n = (int)courses.size();
+    int k = (int)slots.size();
+    vector<int> color(n, -1);
+    vector<long long> slotCost((size_t)n * k, 0);
+    vector<int> saturation(n, 0);
+    vector<long long> degree(n, 0);
+
+    for (int u = 0; u < n; u++) {
+        for (int e = edgeStart[u]; e < edgeStart[u + 1]; e++) degree[u] += edgeWeight[e];
+    }
+
+    set<tuple<int, long long, int>> queue;
+    for (int u = 0; u < n; u++) queue.insert(make_tuple(0, degree[u], -u));
+
+    while (!queue.empty()) {
+        int u = -get<2>(*queue.rbegin());
+        queue.erase(prev(queue.end()));
+
+        int best = 0;
+        for (int s = 1; s < k; s++) {
+            if (slotCost[(size_t)u * k + s] < slotCost[(size_t)u * k + best]) best = s;
+        }
+        color[u] = best;
+
+        for (int e = edgeStart[u]; e < edgeStart[u + 1]; e++) {
+            int v = edgeTo[e];
+            if (color[v] != -1) continue;
+            long long& c = slotCost[(size_t)v * k + best];
+            if (c == 0) {
+                queue.erase(make_tuple(saturation[v], degree[v], -v));
+                saturation[v]++;
+                queue.insert(make_tuple(saturation[v], degree[v], -v));
+            }
+            c += edgeWeight[e];
+        }
+    }
+    return color;
+}
+
+ScheduleResult TimetableScheduler::solve(const SchedulerOptions& options) {
+    ScheduleResult result;
+    result.cost = 0;
+    result.hardConflicts = 0;
+    result.studentClashes = 0;
+
+    int n = (int)courses.size();
+    int k = (int)slots.size();
+    if (n == 0 || k == 0) return result;
+
+    auto start = chrono::steady_clock::now();
+    auto elapsedMs = [&start]() {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    };
+    auto deadline = start + chrono::milliseconds(options.timeLimitMs);
+
+    buildGraph();
+    vector<int> bestColor = dsatur();
+    long long bestCost = costOf(bestColor);
+    result.progress.push_back({ elapsedMs(), bestCost });
+
+    const vector<int> seedColor = bestColor;
+    mutex bestLock;
+    atomic<bool> solved(bestCost == 0);
+
+    // Tabu search over single-course slot moves. gamma[u][s] is the conflict
+    // weight u would have in slot s, so every move is evaluated in O(1).
+    auto search = [&](unsigned int seed) {
+        mt19937 rng(seed);
+        vector<int> color = seedColor;
+        vector<long long> gamma((size_t)n * k, 0);
+        vector<long long> tabuUntil((size_t)n * k, 0);
+        for (int u = 0; u < n; u++) {
+            for (int e = edgeStart[u]; e < edgeStart[u + 1]; e++) {
+                gamma[(size_t)u * k + color[edgeTo[e]]] += edgeWeight[e];
+            }
+        }
+
+        vector<int> conflicting;
+        vector<int> position(n, -1);
+        auto refresh = [&](int u) {
+            bool inConflict = gamma[(size_t)u * k + color[u]] > 0;
+            if (inConflict && position[u] == -1) {
+                position[u] = (int)conflicting.size();
+                conflicting.push_back(u);
+            }
+            else if (!inConflict && position[u] != -1) {
+                int last = conflicting.back();
+                conflicting[position[u]] = last;
+                position[last] = position[u];
+                conflicting.pop_back();
+                position[u] = -1;
+            }
+        };
+        for (int u = 0; u < n; u++) refresh(u);
+
+        long long cost = costOf(color);
+        long long localBest = cost;
+        for (long long iter = 1; !solved && cost > 0; iter++) {
+            if (options.maxIterations > 0 && iter > options.maxIterations) break;
+            if ((iter & 255) == 0 && chrono::steady_clock::now() >= deadline) break;
+
+            int moveU = -1, moveS = -1, ties = 0;
+            long long moveDelta = 0;
+            // Best tabu move, taken when every move is tabu so the search never idles
+            int tabuU = -1, tabuS = -1;
+            long long tabuDelta = 0;
+            for (int u : conflicting) {
+                long long current = gamma[(size_t)u * k + color[u]];
+                for (int s = 0; s < k; s++) {
+                    if (s == color[u]) continue;
+                    long long delta = gamma[(size_t)u * k + s] - current;
+                    bool tabu = tabuUntil[(size_t)u * k + s] > iter;
+                    if (tabu && cost + delta >= localBest) {
+                        if (tabuU == -1 || delta < tabuDelta) {
+                            tabuU = u; tabuS = s; tabuDelta = delta;
+                        }
+                        continue;
+                    }
+
+                    if (moveU == -1 || delta < moveDelta) {
+                        moveU = u; moveS = s; moveDelta = delta; ties = 1;
+                    }
+                    else if (delta == moveDelta && rng() % ++ties == 0) {
+                        moveU = u; moveS = s;
+                    }
+                }
+            }
+            if (moveU == -1) {
+                if (tabuU == -1) break;
+                moveU = tabuU; moveS = tabuS; moveDelta = tabuDelta;
+            }
+
+            int from = color[moveU];
+            color[moveU] = moveS;
+            cost += moveDelta;
+            tabuUntil[(size_t)moveU * k + from] =
+                iter + (long long)(rng() % 10) + (long long)(conflicting.size() * 6 / 10);
+
+            for (int e = edgeStart[moveU]; e < edgeStart[moveU + 1]; e++) {
+                int v = edgeTo[e];
+                gamma[(size_t)v * k + from] -= edgeWeight[e];
+                gamma[(size_t)v * k + moveS] += edgeWeight[e];
+                refresh(v);
+            }
+            refresh(moveU);
+
+            if (cost < localBest) {
+                localBest = cost;
+                lock_guard<mutex> guard(bestLock);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestColor = color;
+                    result.progress.push_back({ elapsedMs(), cost });
+                    if (cost == 0) solved = true;
+                }
+            }
+        }
+    };
+
+    int threadCount = options.threads > 0 ? options.threads : (int)thread::hardware_concurrency();
+    threadCount = max(1, threadCount);
+    // With a single slot there is no move to make
+    if (!solved && k > 1) {
+        vector<thread> workers;
+        for (int t = 0; t < threadCount; t++) {
+            workers.emplace_back(search, options.seed + 7919u * t);
+        }
+        for (thread& w : workers) w.join();
+    }
+
+    result.cost = bestCost;
+    for (int u = 0; u < n; u++) {
+        result.slotOf[courses[u]] = slots[bestColor[u]];
+        for (const auto& e : hard[u]) {
+            if (e.first > u && bestColor[e.first] == bestColor[u]) result.hardConflicts += e.second;
+        }
+        for (const auto& e : students[u]) {
+            if (e.first > u && bestColor[e.first] == bestColor[u]) result.studentClashes += e.second;
+        }
+    }
+    return result;
+}
+
+void TimetableScheduler::displaySchedule(const ScheduleResult& result) const {
+    cout << "\n>> Generated Timetable:\n";
+    cout << "---------------------------------------\n";
+    for (const string& slot : slots) {
+        cout << "  " << slot << ":";
+        for (const auto& pair : result.slotOf) {
+            if (pair.second == slot) cout << " " << pair.first;
+        }
+        cout << "\n";
+    }
+    cout << "---------------------------------------\n";
+    cout << "Faculty/room clashes: " << result.hardConflicts << "\n";
+    cout << "Student double-bookings: " << result.studentClashes << "\n";
+
+    cout << "\nSolution quality over time:\n";
+    for (const ScheduleProgress& p : result.progress) {
+        cout << "  " << fixed << setprecision(1) << setw(10) << p.elapsedMs << " ms  cost "
+            << p.cost << "\n";
+    }
+}
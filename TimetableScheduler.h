@@ -0,0 +1,73 @@
+#ifndef TIMETABLESCHEDULER_H
+#define TIMETABLESCHEDULER_H
+
+#include "ConsistencyChecker.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+struct SchedulerOptions {
+    int threads = 0;              // 0 = one per hardware thread
+    int timeLimitMs = 10000;
+    long long maxIterations = 0;  // per thread, 0 = until time limit or zero cost
+    unsigned int seed = 1;
+};
+
+struct ScheduleProgress {
+    double elapsedMs;
+    long long cost;
+};
+
+struct ScheduleResult {
+    std::map<std::string, std::string> slotOf;  // course -> slot
+    long long cost;
+    int hardConflicts;         // pairs sharing a faculty member or room in one slot
+    long long studentClashes;  // students double-booked, summed over course pairs
+    std::vector<ScheduleProgress> progress;  // every improvement of the best cost
+};
+
+// Assigns a time slot to every course so that courses sharing a faculty member
+// or room never meet together and as few students as possible are double-booked.
+// Courses are vertices of a weighted conflict graph: DSATUR colouring gives the
+// seed, then tabu search runs on several threads from that seed.
+class TimetableScheduler {
+private:
+    static const long long HARD_WEIGHT = 1000000;
+
+    std::vector<std::string> courses;
+    std::unordered_map<std::string, int> courseIdx;
+    std::vector<std::string> slots;
+    std::vector<std::unordered_map<int, long long>> students;  // shared students per pair
+    std::vector<std::unordered_map<int, int>> hard;            // shared faculty/room per pair
+    std::map<std::string, std::vector<int>> facultyCourses;
+    std::map<std::string, std::vector<int>> roomCourses;
+
+    // Conflict graph in compressed form, rebuilt by solve()
+    std::vector<int> edgeStart;
+    std::vector<int> edgeTo;
+    std::vector<long long> edgeWeight;
+
+    int indexOf(const std::string& course);
+    void buildGraph();
+    std::vector<int> dsatur() const;
+    long long costOf(const std::vector<int>& color) const;
+
+public:
+    TimetableScheduler();
+
+    void addCourse(const std::string& course);
+    void addSlot(const std::string& slot);
+    void addAssignment(const Assignment& assignment);
+    void addOverlap(const std::string& course1, const std::string& course2, long long sharedStudents);
+
+    // Takes courses and assignments from the checker and derives student overlap
+    // from its enrollments
+    void loadFrom(const ConsistencyChecker& checker);
+
+    ScheduleResult solve(const SchedulerOptions& options = SchedulerOptions());
+    void displaySchedule(const ScheduleResult& result) const;
+    int getCourseCount() const { return (int)courses.size(); }
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include "WorkloadGenerator.h"
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
+
+using namespace std;
+
+WorkloadGenerator::WorkloadGenerator(unsigned long long seed) : rng(seed) {}
+
+int WorkloadGenerator::pick(int bound) {
+    return (int)(rng() % (unsigned long long)max(1, bound));
+}
+
+string WorkloadGenerator::courseName(int i) {
+    return "CRS" + to_string(i);
+}
+
+static void checkCatalogArgs(int n, int width, double density) {
+    if (n < 0) throw invalid_argument("Catalog size must not be negative");
+    if (width < 1) throw invalid_argument("Layer width must be at least 1");
+    if (!(density >= 0.0 && density <= 1.0)) throw invalid_argument("Edge density must be in [0, 1]");
+}
+
+// First base at or after the catalog's size whose n generated names are all unused
+template <typename Catalog>
+static int freeBase(const Catalog& catalog, int n) {
+    int base = catalog.getCourseCount();
+    for (int i = 0; i < n; i++) {
+        if (catalog.hasCourse(WorkloadGenerator::courseName(base + i))) {
+            base += i + 1;
+            i = -1;
+        }
+    }
+    return base;
+}
+
+vector<string> WorkloadGenerator::generateCatalog(CourseGraph& graph, int n, int width, double density) {
+    checkCatalogArgs(n, width, density);
+    int base = freeBase(graph, n);
+    int first = graph.getCourseCount();
+    vector<string> names;
+    for (int i = 0; i < n; i++) {
+        names.push_back(courseName(base + i));
+        graph.addCourse(names.back());
+    }
+
+    bernoulli_distribution edge(density);
+    for (int start = width; start < n; start += width) {
+        int prevStart = start - width;
+        int end = min(n, start + width);
+        for (int v = start; v < end; v++) {
+            for (int u = prevStart; u < start; u++) {
+                if (edge(rng)) graph.addEdge(first + u, first + v);
+            }
+        }
+    }
+    return names;
+}
+
+vector<string> WorkloadGenerator::generateCatalog(ConsistencyChecker& checker, int n, int width, double density) {
+    checkCatalogArgs(n, width, density);
+    int base = freeBase(checker, n);
+    vector<string> names;
+    for (int i = 0; i < n; i++) {
+        names.push_back(courseName(base + i));
+        checker.addCourse(names.back());
+    }
+
+    bernoulli_distribution edge(density);
+    for (int start = width; start < n; start += width) {
+        int prevStart = start - width;
+        int end = min(n, start + width);
+        for (int v = start; v < end; v++) {
+            for (int u = prevStart; u < start; u++) {
+                if (edge(rng)) checker.addPrerequisite(names[v], names[u]);
+            }
+        }
+    }
+    return names;
+}
+
+void WorkloadGenerator::generatePopulation(ConsistencyChecker& checker, const vector<string>& courses,
+    int students, int coursesPerStudent, int faculty, int rooms, int slots) {
+    if (students < 0 || coursesPerStudent < 0) {
+        throw invalid_argument("Population counts must not be negative");
+    }
+    if (faculty < 1 || rooms < 1 || slots < 1) {
+        throw invalid_argument("Faculty, room and slot counts must be at least 1");
+    }
+
+    for (const string& course : courses) {
+        checker.addCourseCredit(course, 3 + pick(2));
+        checker.addAssignment("FAC" + to_string(pick(faculty)), course,
+            "ROOM" + to_string(pick(rooms)));
+    }
+
+    int count = (int)courses.size();
+    int perStudent = min(coursesPerStudent, count);
+    vector<int> chosen;
+    for (int s = 0; s < students; s++) {
+        chosen.clear();
+        while ((int)chosen.size() < perStudent) {
+            int c = pick(count);
+            if (find(chosen.begin(), chosen.end(), c) == chosen.end()) chosen.push_back(c);
+        }
+        for (int c : chosen) {
+            checker.addEnrollment("STU" + to_string(s), courses[c], "T" + to_string(pick(slots)));
+        }
+    }
+}
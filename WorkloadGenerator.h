@@ -0,0 +1,38 @@
+#ifndef WORKLOADGENERATOR_H
+#define WORKLOADGENERATOR_H
+
+#include "CourseGraph.h"
+#include "ConsistencyChecker.h"
+#include <string>
+#include <vector>
+#include <random>
+
+// Seeded synthetic data for benchmarks: the same seed and parameters always
+// produce the same catalog and population. Invalid sizes or densities throw
+// std::invalid_argument.
+class WorkloadGenerator {
+private:
+    std::mt19937_64 rng;
+
+    int pick(int bound);
+
+public:
+    explicit WorkloadGenerator(unsigned long long seed);
+
+    static std::string courseName(int i);
+
+    // Layered random DAG: n courses in layers of `width`, each possible edge
+    // from one layer to the next present with probability `density`. Every
+    // course is registered, with or without edges. Names continue after the
+    // courses already present and never reuse one; returns the new names.
+    std::vector<std::string> generateCatalog(CourseGraph& graph, int n, int width, double density);
+    std::vector<std::string> generateCatalog(ConsistencyChecker& checker, int n, int width, double density);
+
+    // Credits and a faculty/room assignment for each of `courses` (normally a
+    // generated catalog), then `students` students each enrolled in
+    // coursesPerStudent distinct courses from it
+    void generatePopulation(ConsistencyChecker& checker, const std::vector<std::string>& courses,
+        int students, int coursesPerStudent, int faculty, int rooms, int slots);
+};
+
+#endif